@@ -0,0 +1,582 @@
+// Voxel storage benchmarks. Runs on a headless world, so no GPU is needed:
+//   VoxelBenchmarks [filter]
+// runs every benchmark whose name contains filter, or all of them. Each
+// brick size has its own executable (VoxelBenchmarks8 to VoxelBenchmarks64),
+// the benchmark_matrix target runs them one after another.
+
+#include "engine/voxel/World.h"
+#include "engine/voxel/VoxelAccessor.h"
+#include "engine/voxel/BrickMesher.h"
+#include "engine/voxel/MeshJobPool.h"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace voxceleron;
+
+namespace {
+
+constexpr int SCENE_SIZE = 256;     // Voxels per axis of the benchmark scene
+
+// Terrain-like scene: a rolling solid floor with scattered noise, so most
+// bricks near the surface hold more than one value
+void buildScene(World& world) {
+    MaterialId stone = world.getMaterials().add(Material{0x808080FF});
+    MaterialId dirt = world.getMaterials().add(Material{0x8B5A2BFF});
+
+    std::mt19937 rng(1);
+    std::vector<VoxelEdit> edits;
+    for (int z = 0; z < SCENE_SIZE; ++z) {
+        for (int x = 0; x < SCENE_SIZE; ++x) {
+            int height = SCENE_SIZE / 2 + static_cast<int>(24.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f));
+            world.fillBox(glm::ivec3(x, 0, z), glm::ivec3(x + 1, height, z + 1), Voxel{stone});
+            for (int y = height - 4; y < height; ++y) {
+                if (rng() % 3 == 0) {
+                    edits.push_back(VoxelEdit{glm::ivec3(x, y, z), Voxel{dirt}});
+                }
+            }
+        }
+    }
+    world.setVoxels(edits.data(), edits.size());
+}
+
+// Best of a few runs, in nanoseconds per voxel
+double measure(size_t voxels, const std::function<void()>& run) {
+    double best = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / voxels;
+        best = (i == 0 || ns < best) ? ns : best;
+    }
+    return best;
+}
+
+// Baseline is the plain World call, per voxel getVoxel or setVoxel
+void report(const char* name, double baseline, double optimized) {
+    std::printf("%-24s baseline %7.2f ns  optimized %7.2f ns  speedup %5.2fx\n",
+                name, baseline, optimized, baseline / optimized);
+}
+
+// Storage of the built scene, the memory column of the brick size matrix
+void reportMemory(const World& world) {
+    WorldStats stats = world.getStats();
+    std::printf("%-24s nodes %8u  bricks %6zu KiB  nodes %6zu KiB  resident %6zu KiB\n",
+                "scene memory", stats.leafNodes + stats.internalNodes,
+                stats.payloadBytes / 1024, stats.nodeBytes / 1024, stats.residentBytes / 1024);
+}
+
+// The sum keeps the reads from being optimized away
+volatile uint32_t sink;
+
+void benchScanline(World& world) {
+    const size_t voxels = size_t(SCENE_SIZE) * SCENE_SIZE * SCENE_SIZE;
+    double baseline = measure(voxels, [&]() {
+        uint32_t sum = 0;
+        for (int z = 0; z < SCENE_SIZE; ++z)
+            for (int y = 0; y < SCENE_SIZE; ++y)
+                for (int x = 0; x < SCENE_SIZE; ++x)
+                    sum += world.getVoxel(glm::ivec3(x, y, z)).material;
+        sink = sum;
+    });
+
+    VoxelAccessor accessor(world);
+    double cached = measure(voxels, [&]() {
+        uint32_t sum = 0;
+        for (int z = 0; z < SCENE_SIZE; ++z)
+            for (int y = 0; y < SCENE_SIZE; ++y)
+                for (int x = 0; x < SCENE_SIZE; ++x)
+                    sum += accessor.get(glm::ivec3(x, y, z)).material;
+        sink = sum;
+    });
+    report("scanline get", baseline, cached);
+}
+
+void benchNeighbors(World& world) {
+    // Six face neighbors of every voxel, as lighting and meshing read them
+    static const glm::ivec3 offsets[6] = {
+        {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}
+    };
+    const int size = SCENE_SIZE / 2;
+    const size_t voxels = size_t(size) * size * size * 6;
+    double baseline = measure(voxels, [&]() {
+        uint32_t sum = 0;
+        for (int z = 0; z < size; ++z)
+            for (int y = 0; y < size; ++y)
+                for (int x = 0; x < size; ++x)
+                    for (const glm::ivec3& offset : offsets)
+                        sum += world.getVoxel(glm::ivec3(x, y + size / 2, z) + offset).material;
+        sink = sum;
+    });
+
+    VoxelAccessor accessor(world);
+    double cached = measure(voxels, [&]() {
+        uint32_t sum = 0;
+        for (int z = 0; z < size; ++z)
+            for (int y = 0; y < size; ++y)
+                for (int x = 0; x < size; ++x)
+                    for (const glm::ivec3& offset : offsets)
+                        sum += accessor.get(glm::ivec3(x, y + size / 2, z) + offset).material;
+        sink = sum;
+    });
+    report("neighbor get", baseline, cached);
+}
+
+void benchScanlineSet(World& world) {
+    const int size = SCENE_SIZE / 2;
+    const size_t voxels = size_t(size) * size * size;
+    MaterialId a = world.getMaterials().add(Material{0xFF0000FF});
+    MaterialId b = world.getMaterials().add(Material{0x0000FFFF});
+
+    double baseline = measure(voxels, [&]() {
+        for (int z = 0; z < size; ++z)
+            for (int y = 0; y < size; ++y)
+                for (int x = 0; x < size; ++x)
+                    world.setVoxel(glm::ivec3(x, y, z), Voxel{(x ^ y ^ z) & 1 ? a : b});
+    });
+
+    VoxelAccessor accessor(world);
+    double cached = measure(voxels, [&]() {
+        for (int z = 0; z < size; ++z)
+            for (int y = 0; y < size; ++y)
+                for (int x = 0; x < size; ++x)
+                    accessor.set(glm::ivec3(x, y, z), Voxel{(x ^ y ^ z) & 1 ? b : a});
+    });
+    report("scanline set", baseline, cached);
+}
+
+void benchExtract(World& world) {
+    // A 64^3 chunk with a one voxel border, as a mesher would request it
+    const int size = 66;
+    const size_t voxels = size_t(size) * size * size;
+    const glm::ivec3 min(31, SCENE_SIZE / 2 - 33, 31);
+    std::vector<MaterialId> buffer(voxels);
+
+    double baseline = measure(voxels, [&]() {
+        size_t i = 0;
+        for (int z = 0; z < size; ++z)
+            for (int y = 0; y < size; ++y)
+                for (int x = 0; x < size; ++x)
+                    buffer[i++] = world.getVoxel(min + glm::ivec3(x, y, z)).material;
+    });
+    double dense = measure(voxels, [&]() {
+        world.extractRegion(min, min + glm::ivec3(size), buffer.data());
+    });
+    report("extract region", baseline, dense);
+}
+
+void benchNodeNeighbors(World& world) {
+    // All 26 neighbors of every brick in the scene, as meshing and lighting need them
+    const int size = static_cast<int>(BRICK_SIZE);
+    const int cells = SCENE_SIZE / size;
+    const size_t lookups = size_t(cells) * cells * cells * 26;
+    std::vector<NodeLocation> locations;
+    for (int z = 0; z < cells; ++z)
+        for (int y = 0; y < cells; ++y)
+            for (int x = 0; x < cells; ++x)
+                locations.push_back(world.locateNode(glm::ivec3(x, y, z) * size, BRICK_LEVEL));
+
+    // Baseline descends from the root for each neighbor
+    double baseline = measure(lookups, [&]() {
+        uint32_t sum = 0;
+        for (const NodeLocation& location : locations)
+            for (int dz = -1; dz <= 1; ++dz)
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                        if (dx != 0 || dy != 0 || dz != 0)
+                            sum += world.locateNode(location.position() + glm::ivec3(dx, dy, dz) * size, BRICK_LEVEL).nodeIndex;
+        sink = sum;
+    });
+
+    std::array<NodeLocation, 26> neighbors;
+    double batched = measure(lookups, [&]() {
+        uint32_t sum = 0;
+        for (const NodeLocation& location : locations) {
+            world.findNeighbors(location, neighbors);
+            for (const NodeLocation& neighbor : neighbors)
+                sum += neighbor.nodeIndex;
+        }
+        sink = sum;
+    });
+    report("26 neighbors", baseline, batched);
+}
+
+void benchCountSolid(World& world) {
+    // Most of the scene, unaligned so partly covered bricks are counted too
+    const glm::ivec3 min(3, 5, 7);
+    const glm::ivec3 max(SCENE_SIZE - 9, SCENE_SIZE - 3, SCENE_SIZE - 1);
+    const glm::ivec3 extent = max - min;
+    const size_t voxels = size_t(extent.x) * extent.y * extent.z;
+    std::vector<MaterialId> buffer(voxels);
+
+    // Baseline is the fastest way without summaries, a dense copy to count
+    double baseline = measure(voxels, [&]() {
+        world.extractRegion(min, max, buffer.data());
+        uint32_t count = 0;
+        for (MaterialId material : buffer) {
+            count += material != MATERIAL_AIR;
+        }
+        sink = count;
+    });
+    double summary = measure(voxels, [&]() {
+        sink = static_cast<uint32_t>(world.countSolid(min, max));
+    });
+    report("count solid", baseline, summary);
+}
+
+// Regions drawn by the renderer stay resident under a memory budget, even
+// beyond the radius kept around the viewer. Marks regions the way the
+// renderer's frustum walk does and times the updates that compress the rest.
+void benchBudget(World&) {
+    constexpr int REGIONS = 8;
+    const glm::ivec3 viewed[] = {glm::ivec3(0), glm::ivec3(5, 0, 0)};
+    World world(nullptr);
+    std::mt19937 rng(3);
+    for (int r = 0; r < REGIONS; ++r) {
+        glm::ivec3 origin = World::regionOrigin(glm::ivec3(r, 0, 0));
+        world.fillBox(origin, origin + glm::ivec3(128, 32, 128), Voxel{1});
+        for (int i = 0; i < 4096; ++i) {
+            world.setVoxel(origin + glm::ivec3(rng() % 128, 32, rng() % 128), Voxel{2});
+        }
+    }
+    world.update();
+    world.setMemoryBudget(world.getStats().residentBytes / REGIONS * 3);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < 4; ++frame) {
+        for (const glm::ivec3& coord : viewed) {
+            world.markRegionViewed(coord);
+        }
+        world.update();
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t resident = 0;
+    for (const glm::ivec3& coord : viewed) {
+        resident += world.getRegionRoot(coord) != INVALID_INDEX;
+    }
+    std::printf("%-24s regions %u  compressed %u  viewed resident %u/%zu  %7.2f ms\n", "budget with view",
+                REGIONS, world.getStats().compressedRegions, resident, std::size(viewed), ms);
+    if (resident != std::size(viewed)) {
+        std::printf("%-24s FAILED: a viewed region was compressed\n", "budget with view");
+    }
+}
+
+// Node count of the traversal scene, a world well past cache sizes
+constexpr size_t TRAVERSE_NODES = 10000000;
+
+// The octree node before the index-based pool: heap allocated, children
+// owned through pointers, position and mesh state stored in every node
+struct PointerNode {
+    uint8_t childMask = 0;
+    bool isLeaf = false;
+    uint32_t level = 0;
+    glm::ivec3 position{0};
+    uint32_t size = 0;
+    bool needsUpdate = true;
+    bool isOptimized = false;
+    uint32_t optimizedValue = 0;
+    std::array<std::unique_ptr<PointerNode>, 8> children;
+    std::shared_ptr<void> meshCache;
+    VkBuffer meshBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory meshMemory = VK_NULL_HANDLE;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+};
+
+// Copies are allocated in walk order, the best layout the old tree could get
+std::unique_ptr<PointerNode> copyPointerTree(const World& world, uint32_t nodeIndex,
+                                             const glm::ivec3& position, uint32_t size) {
+    const OctreeNode& node = world.getNode(nodeIndex);
+    auto copy = std::make_unique<PointerNode>();
+    copy->childMask = node.childMask;
+    copy->isLeaf = node.isLeaf();
+    copy->level = node.level;
+    copy->position = position;
+    copy->size = size;
+    copy->optimizedValue = node.isUniform() ? node.payload : 0;
+    if (!node.isLeaf()) {
+        for (uint32_t i = 0; i < 8; ++i) {
+            if (node.hasChild(i)) {
+                copy->children[i] = copyPointerTree(world, node.child(i),
+                    position + World::childOffset(i, size >> 1), size >> 1);
+            }
+        }
+    }
+    return copy;
+}
+
+void benchTraverse(World&) {
+    // A checkerboard of brick-sized cells in two materials, so no sibling
+    // group collapses and every cell stays a node. It spans several regions
+    // and has its own world, the shared scene is far too small.
+    const int size = static_cast<int>(BRICK_SIZE);
+    const int cells = static_cast<int>(std::ceil(std::cbrt(TRAVERSE_NODES * 7.0 / 8.0)));
+    World world(nullptr);
+    MaterialId a = world.getMaterials().add(Material{0x808080FF});
+    MaterialId b = world.getMaterials().add(Material{0x8B5A2BFF});
+    for (int z = 0; z < cells; ++z)
+        for (int y = 0; y < cells; ++y)
+            for (int x = 0; x < cells; ++x) {
+                glm::ivec3 min = glm::ivec3(x, y, z) * size;
+                world.fillBox(min, min + size, Voxel{((x ^ y ^ z) & 1) ? a : b});
+            }
+    world.update();     // Drains the collapse queue, nothing in a checkerboard merges
+
+    std::vector<std::unique_ptr<PointerNode>> roots;
+    world.traverse([&](const NodeVisit& visit) {
+        roots.push_back(copyPointerTree(world, visit.nodeIndex, visit.position, visit.size));
+        return false;
+    });
+    const size_t nodes = world.countNodes();
+    std::printf("%-24s nodes %8zu  regions %3zu  pool %6zu MiB  pointers %6zu MiB\n", "traverse scene",
+                nodes, roots.size(), world.getStats().nodeBytes >> 20, (nodes * sizeof(PointerNode)) >> 20);
+
+    // Baselines are the walks as they were, recursive std::function calls
+    // through the child pointers
+    double baseline = measure(nodes, [&]() {
+        std::function<size_t(const PointerNode*)> count = [&](const PointerNode* node) -> size_t {
+            size_t total = 1;
+            if (!node->isLeaf) {
+                for (uint32_t i = 0; i < 8; ++i) {
+                    if (node->childMask & (1u << i)) {
+                        total += count(node->children[i].get());
+                    }
+                }
+            }
+            return total;
+        };
+        size_t total = 0;
+        for (const auto& root : roots) {
+            total += count(root.get());
+        }
+        sink = static_cast<uint32_t>(total);
+    });
+    double pooled = measure(nodes, [&]() {
+        sink = static_cast<uint32_t>(world.countNodes());
+    });
+    report("count nodes", baseline, pooled);
+
+    // The positioned walk LOD selection and meshing use
+    baseline = measure(nodes, [&]() {
+        int sum = 0;
+        std::function<void(const PointerNode*)> walk = [&](const PointerNode* node) {
+            sum += node->position.x + node->size;
+            if (node->isLeaf) return;
+            for (uint32_t i = 0; i < 8; ++i) {
+                if (node->childMask & (1u << i)) {
+                    walk(node->children[i].get());
+                }
+            }
+        };
+        for (const auto& root : roots) {
+            walk(root.get());
+        }
+        sink = static_cast<uint32_t>(sum);
+    });
+    pooled = measure(nodes, [&]() {
+        int sum = 0;
+        world.traverse([&](const NodeVisit& visit) {
+            sum += visit.position.x + static_cast<int>(visit.size);
+            return true;
+        });
+        sink = static_cast<uint32_t>(sum);
+    });
+    report("positioned walk", baseline, pooled);
+}
+
+// One quad per visible voxel face, what mesh_generator.comp emits
+void meshPerFace(const MaterialId* voxels, std::vector<MeshQuad>& quads) {
+    static const glm::ivec3 offsets[6] = {
+        {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}
+    };
+    const int size = static_cast<int>(BRICK_SIZE);
+    for (int z = 0; z < size; ++z)
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x) {
+                if (!isSolidVoxel(voxels[Brick::index(x, y, z)])) continue;
+                for (uint32_t face = 0; face < 6; ++face) {
+                    glm::ivec3 next = glm::ivec3(x, y, z) + offsets[face];
+                    bool inside = next.x >= 0 && next.y >= 0 && next.z >= 0 &&
+                                  next.x < size && next.y < size && next.z < size;
+                    if (inside && isSolidVoxel(voxels[Brick::index(next)])) continue;
+                    quads.push_back(MeshQuad::pack(glm::ivec3(x, y, z), face, 1, 1, voxels[Brick::index(x, y, z)]));
+                }
+            }
+}
+
+// The apron of the brick at min, read back from the box one voxel larger
+BrickApron extractApron(World& world, const glm::ivec3& min) {
+    const int size = static_cast<int>(BRICK_SIZE);
+    const int padded = size + 2;
+    std::vector<MaterialId> box(padded * padded * padded);
+    world.extractRegion(min - 1, min + size + 1, box.data());
+
+    BrickApron apron;
+    for (uint32_t face = 0; face < 6; ++face) {
+        const int axis = face >> 1;
+        uint64_t* rows = apron.faceRows(face);
+        for (int v = 0; v < size; ++v) {
+            for (int u = 0; u < size; ++u) {
+                glm::ivec3 pos;
+                pos[axis] = (face & 1) ? size + 1 : 0;
+                pos[(axis + 1) % 3] = u + 1;
+                pos[(axis + 2) % 3] = v + 1;
+                if (isSolidVoxel(box[pos.x + padded * (pos.y + padded * pos.z)])) {
+                    rows[v] |= uint64_t(1) << u;
+                }
+            }
+        }
+    }
+    return apron;
+}
+
+void benchMesh(World& world) {
+    // Every brick of the scene crossing the surface, as the mesh queue sees them
+    const int size = static_cast<int>(BRICK_SIZE);
+    const int cells = SCENE_SIZE / size;
+    std::vector<MaterialId> bricks;
+    std::vector<BrickApron> aprons;
+    for (int z = 0; z < cells; ++z)
+        for (int y = 0; y < cells; ++y)
+            for (int x = 0; x < cells; ++x) {
+                glm::ivec3 min = glm::ivec3(x, y, z) * size;
+                uint64_t solid = world.countSolid(min, min + size);
+                if (solid == 0 || solid == BRICK_VOLUME) continue;
+                bricks.resize(bricks.size() + BRICK_VOLUME);
+                world.extractRegion(min, min + size, bricks.data() + bricks.size() - BRICK_VOLUME);
+                aprons.push_back(extractApron(world, min));
+            }
+    const size_t voxels = bricks.size();
+
+    std::vector<MeshQuad> quads;
+    size_t perFaceQuads = 0, greedyQuads = 0;
+    double baseline = measure(voxels, [&]() {
+        perFaceQuads = 0;
+        for (size_t i = 0; i < voxels; i += BRICK_VOLUME) {
+            quads.clear();
+            meshPerFace(bricks.data() + i, quads);
+            perFaceQuads += quads.size();
+        }
+    });
+
+    // Like the baseline, without neighbors every brick border counts as air
+    GreedyMesher mesher;
+    const BrickApron air;
+    double greedy = measure(voxels, [&]() {
+        greedyQuads = 0;
+        for (size_t i = 0; i < voxels; i += BRICK_VOLUME) {
+            quads.clear();
+            mesher.meshBrick(bricks.data() + i, air, quads);
+            greedyQuads += quads.size();
+        }
+    });
+    report("greedy mesh", baseline, greedy);
+
+    size_t apronQuads = 0;
+    for (size_t i = 0; i < voxels; i += BRICK_VOLUME) {
+        quads.clear();
+        mesher.meshBrick(bricks.data() + i, aprons[i / BRICK_VOLUME], quads);
+        apronQuads += quads.size();
+    }
+    std::printf("%-24s bricks %6zu  per-face quads %8zu  greedy quads %8zu  with apron %8zu\n",
+                "mesh output", voxels / BRICK_VOLUME, perFaceQuads, greedyQuads, apronQuads);
+
+    // An indexed quad is 4 vertices and 6 indices, bricks never need 32-bit
+    // indices. Before packing a vertex was 8 floats with 32-bit indices. The
+    // face list stores the quad itself.
+    const size_t floatQuadBytes = 4 * 8 * sizeof(float) + 6 * sizeof(uint32_t);
+    const size_t packedQuadBytes = 4 * sizeof(MeshVertex) + 6 * sizeof(uint16_t);
+    const size_t faceListQuadBytes = sizeof(MeshQuad);
+    std::printf("%-24s bytes/quad %3zu -> %3zu -> %zu  total %8zu -> %8zu -> %8zu KiB\n",
+                "mesh memory", floatQuadBytes, packedQuadBytes, faceListQuadBytes,
+                greedyQuads * floatQuadBytes / 1024, greedyQuads * packedQuadBytes / 1024,
+                greedyQuads * faceListQuadBytes / 1024);
+}
+
+void benchMeshThreads(World& world) {
+    // The surface bricks meshed by the job pool from one snapshot, as
+    // generateMeshes hands them out, at 1 to N workers
+    const int size = static_cast<int>(BRICK_SIZE);
+    const int cells = SCENE_SIZE / size;
+    std::vector<uint32_t> bricks;
+    for (int z = 0; z < cells; ++z)
+        for (int y = 0; y < cells; ++y)
+            for (int x = 0; x < cells; ++x) {
+                glm::ivec3 min = glm::ivec3(x, y, z) * size;
+                uint64_t solid = world.countSolid(min, min + size);
+                if (solid == 0 || solid == BRICK_VOLUME) continue;
+                uint32_t nodeIndex = world.locateNode(min, BRICK_LEVEL).nodeIndex;
+                if (nodeIndex != INVALID_INDEX && world.getNode(nodeIndex).level == BRICK_LEVEL) {
+                    bricks.push_back(nodeIndex);
+                }
+            }
+
+    std::shared_ptr<const WorldSnapshot> snapshot = world.createSnapshot();
+    const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double single = 0.0;
+    for (uint32_t threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        MeshJobPool pool(MeshBackend::CpuGreedy, threads);
+        double best = 0.0;
+        for (int run = 0; run < 3; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t nodeIndex : bricks) {
+                auto job = std::make_unique<MeshJob>();
+                job->nodeIndex = nodeIndex;
+                job->snapshot = snapshot;
+                pool.submit(std::move(job));
+            }
+            size_t done = 0;
+            while (done < bricks.size()) {
+                done += pool.drain([](MeshJob&) {});
+                std::this_thread::yield();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = std::max(best, bricks.size() / seconds);
+        }
+        single = threads == 1 ? best : single;
+        std::printf("%-24s threads %3u  %9.0f chunks/s  scaling %5.2fx\n", "mesh jobs", threads, best, best / single);
+        if (threads == maxThreads) break;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    struct Benchmark {
+        const char* name;
+        void (*run)(World&);
+    };
+    const Benchmark benchmarks[] = {
+        {"accessor/scanline", benchScanline},
+        {"accessor/neighbors", benchNeighbors},
+        {"accessor/scanline-set", benchScanlineSet},
+        {"region/extract", benchExtract},
+        {"node/neighbors", benchNodeNeighbors},
+        {"region/count-solid", benchCountSolid},
+        {"region/budget", benchBudget},
+        {"mesh/greedy", benchMesh},
+        {"mesh/threads", benchMeshThreads},
+        {"tree/traverse", benchTraverse},
+    };
+
+    std::printf("brick %u^3, scene %d^3\n", BRICK_SIZE, SCENE_SIZE);
+    World world(nullptr);
+    buildScene(world);
+    reportMemory(world);
+    for (const Benchmark& benchmark : benchmarks) {
+        if (std::strstr(benchmark.name, filter)) {
+            benchmark.run(world);
+        }
+    }
+    return 0;
+}
@@ -4,7 +4,17 @@ echo Compiling shaders...
 REM Create shaders directory if it doesn't exist
 if not exist "shaders" mkdir shaders
 
+REM Compile graphics shaders, the runtime loads them from shaders/ under the working directory
+%VULKAN_SDK%\Bin\glslc.exe shaders/basic.vert -o shaders/basic.vert.spv || goto :error
+%VULKAN_SDK%\Bin\glslc.exe shaders/basic.frag -o shaders/basic.frag.spv || goto :error
+%VULKAN_SDK%\Bin\glslc.exe shaders/face.vert -o shaders/face.vert.spv || goto :error
+
 REM Compile compute shader
-%VULKAN_SDK%\Bin\glslc.exe shaders/mesh_generator.comp -o shaders/mesh_generator.comp.spv
+%VULKAN_SDK%\Bin\glslc.exe shaders/mesh_generator.comp -o shaders/mesh_generator.comp.spv || goto :error
+
+echo Done.
+exit /b 0
 
-echo Done. 
\ No newline at end of file
+:error
+echo Shader compilation failed.
+exit /b 1
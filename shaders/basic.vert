@@ -1,10 +1,9 @@
 #version 450
 
-// Vertex attributes
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoord;
-layout(location = 3) in float inLodBlend;
+// Packed vertex, see MeshVertex:
+//   x: position x bits 0-6, y bits 7-13, z bits 14-20, face bits 21-23
+//   y: material bits 0-15, u bits 16-22, v bits 23-29
+layout(location = 0) in uvec2 inVertex;
 
 // Uniform buffer for camera matrices
 layout(binding = 0) uniform UniformBufferObject {
@@ -12,26 +11,42 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4 proj;
 } ubo;
 
+// Node transform, scales node-local mesh units to world space
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+} pc;
+
 // Output to fragment shader
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec2 fragTexCoord;
 layout(location = 3) out float fragLodBlend;
 
+// Normals by face number, 2 * axis + side
+const vec3 FACE_NORMALS[6] = vec3[](
+    vec3(-1, 0, 0), vec3(1, 0, 0),
+    vec3(0, -1, 0), vec3(0, 1, 0),
+    vec3(0, 0, -1), vec3(0, 0, 1)
+);
+
 void main() {
+    vec3 position = vec3(inVertex.x & 0x7Fu, (inVertex.x >> 7) & 0x7Fu, (inVertex.x >> 14) & 0x7Fu);
+    vec3 normal = FACE_NORMALS[(inVertex.x >> 21) & 0x7u];
+    vec2 uv = vec2((inVertex.y >> 16) & 0x7Fu, (inVertex.y >> 23) & 0x7Fu);
+
     // Transform position to clip space
-    gl_Position = ubo.proj * ubo.view * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * ubo.view * pc.model * vec4(position, 1.0);
 
     // Basic lighting calculation
     vec3 lightDir = normalize(vec3(1.0, 1.0, 0.0));
-    float diffuse = max(dot(inNormal, lightDir), 0.2); // 0.2 is ambient light
-    
+    float diffuse = max(dot(normal, lightDir), 0.2); // 0.2 is ambient light
+
     // Simple color based on normal direction
-    vec3 baseColor = vec3(0.7) + inNormal * 0.3;
+    vec3 baseColor = vec3(0.7) + normal * 0.3;
     fragColor = baseColor * diffuse;
 
-    // Pass other attributes to fragment shader
-    fragNormal = inNormal;
-    fragTexCoord = inTexCoord;
-    fragLodBlend = inLodBlend;
-}
\ No newline at end of file
+    // Pass other attributes to fragment shader, uvs repeat once per world voxel
+    fragNormal = normal;
+    fragTexCoord = uv * length(pc.model[0].xyz);
+    fragLodBlend = 0.0;
+}
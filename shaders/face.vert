@@ -0,0 +1,87 @@
+#version 450
+
+// Face-list vertex pulling: every six vertices expand one MeshQuad read from
+// the world's quad buffer, no vertex input or index buffer. The draw's first
+// vertex is six times the mesh's first quad, so gl_VertexIndex / 6 indexes
+// the buffer directly. Corner order, winding and uvs match BrickMesher's
+// appendQuadVertices, so both formats render the same image.
+
+// MeshQuad:
+//   x: origin x bits 0-6, y bits 7-13, z bits 14-20, face bits 21-23, width - 1 bits 24-29
+//   y: material bits 0-15, height - 1 bits 16-21
+layout(std430, set = 0, binding = 0) readonly buffer QuadBuffer {
+    uvec2 quads[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+    vec4 node;      // Origin, and node size / BRICK_SIZE in w
+} pc;
+
+// Output to fragment shader
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord;
+layout(location = 3) out float fragLodBlend;
+
+// Two triangles per quad
+const uint QUAD_CORNERS[6] = uint[](0, 1, 2, 0, 2, 3);
+
+// Unit cube faces by face number, 2 * axis + side, four corners each
+const ivec3 FACE_CORNERS[24] = ivec3[](
+    ivec3(0, 0, 0), ivec3(0, 0, 1), ivec3(0, 1, 1), ivec3(0, 1, 0),
+    ivec3(1, 0, 0), ivec3(1, 1, 0), ivec3(1, 1, 1), ivec3(1, 0, 1),
+    ivec3(0, 0, 0), ivec3(1, 0, 0), ivec3(1, 0, 1), ivec3(0, 0, 1),
+    ivec3(0, 1, 0), ivec3(0, 1, 1), ivec3(1, 1, 1), ivec3(1, 1, 0),
+    ivec3(0, 0, 0), ivec3(0, 1, 0), ivec3(1, 1, 0), ivec3(1, 0, 0),
+    ivec3(0, 0, 1), ivec3(1, 0, 1), ivec3(1, 1, 1), ivec3(0, 1, 1)
+);
+const ivec2 FACE_UVS[24] = ivec2[](
+    ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1),
+    ivec2(1, 0), ivec2(1, 1), ivec2(0, 1), ivec2(0, 0),
+    ivec2(0, 1), ivec2(1, 1), ivec2(1, 0), ivec2(0, 0),
+    ivec2(0, 0), ivec2(0, 1), ivec2(1, 1), ivec2(1, 0),
+    ivec2(1, 0), ivec2(1, 1), ivec2(0, 1), ivec2(0, 0),
+    ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1)
+);
+// The axes each uv component follows
+const ivec2 FACE_UV_AXES[6] = ivec2[](
+    ivec2(2, 1), ivec2(2, 1), ivec2(0, 2), ivec2(0, 2), ivec2(0, 1), ivec2(0, 1)
+);
+const vec3 FACE_NORMALS[6] = vec3[](
+    vec3(-1, 0, 0), vec3(1, 0, 0),
+    vec3(0, -1, 0), vec3(0, 1, 0),
+    vec3(0, 0, -1), vec3(0, 0, 1)
+);
+
+void main() {
+    uvec2 quad = quads[gl_VertexIndex / 6];
+    uint corner = QUAD_CORNERS[gl_VertexIndex % 6];
+
+    uint face = (quad.x >> 21) & 0x7u;
+    int axis = int(face >> 1);
+    ivec3 origin = ivec3(quad.x & 0x7Fu, (quad.x >> 7) & 0x7Fu, (quad.x >> 14) & 0x7Fu);
+    ivec3 extent;
+    extent[axis] = 1;
+    extent[(axis + 1) % 3] = int((quad.x >> 24) & 0x3Fu) + 1;
+    extent[(axis + 2) % 3] = int((quad.y >> 16) & 0x3Fu) + 1;
+
+    uint cornerIndex = face * 4 + corner;
+    vec3 position = vec3(origin + FACE_CORNERS[cornerIndex] * extent);
+    ivec2 uvAxes = FACE_UV_AXES[face];
+    vec2 uv = vec2(FACE_UVS[cornerIndex] * ivec2(extent[uvAxes.x], extent[uvAxes.y]));
+    vec3 normal = FACE_NORMALS[face];
+
+    gl_Position = pc.viewProjection * vec4(pc.node.xyz + position * pc.node.w, 1.0);
+
+    // Same shading as basic.vert
+    vec3 lightDir = normalize(vec3(1.0, 1.0, 0.0));
+    float diffuse = max(dot(normal, lightDir), 0.2); // 0.2 is ambient light
+    vec3 baseColor = vec3(0.7) + normal * 0.3;
+    fragColor = baseColor * diffuse;
+
+    // Uvs repeat once per world voxel
+    fragNormal = normal;
+    fragTexCoord = uv * pc.node.w;
+    fragLodBlend = 0.0;
+}
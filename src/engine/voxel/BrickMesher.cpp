@@ -0,0 +1,184 @@
+#include "BrickMesher.h"
+
+namespace voxceleron {
+
+namespace {
+
+// Unit cube faces by face number, with mesh_generator.comp's corner order,
+// winding and uvs. uvAxes are the axes each uv component follows, the
+// extent along them scales the uv.
+struct CubeFace {
+    int corners[4][3];
+    int uvs[4][2];
+    int uvAxes[2];
+};
+
+const CubeFace CUBE_FACES[6] = {
+    {{{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}, {2, 1}},
+    {{{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}}, {{1, 0}, {1, 1}, {0, 1}, {0, 0}}, {2, 1}},
+    {{{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, {{0, 1}, {1, 1}, {1, 0}, {0, 0}}, {0, 2}},
+    {{{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}}, {{0, 0}, {0, 1}, {1, 1}, {1, 0}}, {0, 2}},
+    {{{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}, {{1, 0}, {1, 1}, {0, 1}, {0, 0}}, {0, 1}},
+    {{{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}, {0, 1}},
+};
+
+// Index of the lowest set bit of a nonzero word, without relying on a
+// compiler intrinsic: the isolated bit times a de Bruijn constant puts a
+// unique pattern in the top six bits
+uint32_t lowestBit(uint64_t x) {
+    static const uint8_t positions[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+    };
+    return positions[((x & (~x + 1)) * 0x03F79D71B4CB0A89ull) >> 58];
+}
+
+} // namespace
+
+void appendQuadVertices(const MeshQuad& quad, std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices) {
+    const uint32_t face = quad.getFace();
+    const uint32_t axis = face >> 1;
+    const CubeFace& cube = CUBE_FACES[face];
+    const glm::ivec3 origin = quad.getOrigin();
+    glm::ivec3 extent;
+    extent[axis] = 1;
+    extent[(axis + 1) % 3] = static_cast<int>(quad.getWidth());
+    extent[(axis + 2) % 3] = static_cast<int>(quad.getHeight());
+
+    uint32_t base = static_cast<uint32_t>(vertices.size());
+    for (int corner = 0; corner < 4; ++corner) {
+        glm::ivec3 pos;
+        for (int i = 0; i < 3; ++i) {
+            pos[i] = origin[i] + cube.corners[corner][i] * extent[i];
+        }
+        vertices.push_back(MeshVertex::pack(pos, face, quad.getMaterial(),
+                                            cube.uvs[corner][0] * extent[cube.uvAxes[0]],
+                                            cube.uvs[corner][1] * extent[cube.uvAxes[1]]));
+    }
+    const uint32_t order[6] = {0, 1, 2, 0, 2, 3};
+    for (uint32_t index : order) {
+        indices.push_back(base + index);
+    }
+}
+
+void appendBoxQuads(uint32_t size, MaterialId material, std::vector<MeshQuad>& quads) {
+    for (uint32_t face = 0; face < 6; ++face) {
+        // High faces draw one past their voxel's origin
+        glm::ivec3 origin(0);
+        origin[face >> 1] = (face & 1) ? static_cast<int>(size) - 1 : 0;
+        quads.push_back(MeshQuad::pack(origin, face, size, size, material));
+    }
+}
+
+std::unique_ptr<BrickMesher> createBrickMesher(MeshBackend backend) {
+    switch (backend) {
+        case MeshBackend::CpuGreedy: return std::make_unique<GreedyMesher>();
+        default: return nullptr;
+    }
+}
+
+void GreedyMesher::meshBrick(const MaterialId* voxels, const BrickApron& apron, std::vector<MeshQuad>& quads) {
+    for (auto& axisColumns : columns) {
+        axisColumns.fill(0);
+    }
+
+    // x columns are the brick's rows, y and z columns collect one bit per row
+    for (uint32_t z = 0; z < SIZE; ++z) {
+        for (uint32_t y = 0; y < SIZE; ++y) {
+            const MaterialId* row = voxels + Brick::index(0, y, z);
+            uint64_t bits = 0;
+            for (uint32_t x = 0; x < SIZE; ++x) {
+                if (!isSolidVoxel(row[x])) continue;
+                bits |= uint64_t(1) << x;
+                columns[1][x * SIZE + z] |= uint64_t(1) << y;
+                columns[2][y * SIZE + x] |= uint64_t(1) << z;
+            }
+            columns[0][z * SIZE + y] = bits;
+        }
+    }
+
+    for (uint32_t face = 0; face < 6; ++face) {
+        const uint32_t axis = face >> 1;
+        const uint32_t axisU = (axis + 1) % 3;
+        const uint32_t axisV = (axis + 2) % 3;
+        const bool high = (face & 1) != 0;
+        const uint64_t* outside = apron.faceRows(face);
+
+        usedPlanes = 0;
+        for (uint32_t v = 0; v < SIZE; ++v) {
+            for (uint32_t u = 0; u < SIZE; ++u) {
+                // A face shows where the next voxel toward it is air, the
+                // apron voxel fills the bit shifted in at the boundary
+                uint64_t column = columns[axis][v * SIZE + u];
+                uint64_t beyond = (outside[v] >> u) & 1;
+                uint64_t visible = high ? column & ~((column >> 1) | (beyond << (SIZE - 1)))
+                                        : column & ~((column << 1) | beyond);
+                while (visible != 0) {
+                    uint32_t depth = lowestBit(visible);
+                    visible &= visible - 1;
+
+                    glm::ivec3 pos;
+                    pos[axis] = depth;
+                    pos[axisU] = u;
+                    pos[axisV] = v;
+                    planesFor(voxels[Brick::index(pos)]).rows[depth * SIZE + v] |= uint64_t(1) << u;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < usedPlanes; ++i) {
+            mergeFaces(face, planes[i], quads);
+        }
+    }
+}
+
+GreedyMesher::FacePlanes& GreedyMesher::planesFor(MaterialId material) {
+    // Few materials share a face direction, the most recent one is the usual hit
+    for (size_t i = usedPlanes; i-- > 0;) {
+        if (planes[i].material == material) return planes[i];
+    }
+    if (usedPlanes == planes.size()) {
+        planes.emplace_back();
+    }
+    FacePlanes& facePlanes = planes[usedPlanes++];
+    facePlanes.material = material;
+    facePlanes.rows.fill(0);
+    return facePlanes;
+}
+
+void GreedyMesher::mergeFaces(uint32_t face, FacePlanes& facePlanes, std::vector<MeshQuad>& quads) {
+    const uint32_t axis = face >> 1;
+    const uint32_t axisU = (axis + 1) % 3;
+    const uint32_t axisV = (axis + 2) % 3;
+
+    for (uint32_t depth = 0; depth < SIZE; ++depth) {
+        uint64_t* rows = facePlanes.rows.data() + depth * SIZE;
+        for (uint32_t v = 0; v < SIZE; ++v) {
+            while (rows[v] != 0) {
+                // Widest run of faces starting at the lowest one in the row
+                uint32_t u = lowestBit(rows[v]);
+                uint64_t run = ~(rows[v] >> u);
+                uint32_t width = run == 0 ? 64 - u : lowestBit(run);
+                uint64_t mask = (width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1) << u;
+                rows[v] &= ~mask;
+
+                // Extend over the rows holding the whole run
+                uint32_t height = 1;
+                while (v + height < SIZE && (rows[v + height] & mask) == mask) {
+                    rows[v + height] &= ~mask;
+                    ++height;
+                }
+
+                glm::ivec3 origin;
+                origin[axis] = depth;
+                origin[axisU] = u;
+                origin[axisV] = v;
+                quads.push_back(MeshQuad::pack(origin, face, width, height, facePlanes.material));
+            }
+        }
+    }
+}
+
+} // namespace voxceleron
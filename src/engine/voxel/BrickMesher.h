@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "VoxelTypes.h"
+#include "MeshTypes.h"
+
+namespace voxceleron {
+
+// Expand a quad into four vertices and two triangles, with the corner order,
+// winding and uvs of mesh_generator.comp; face.vert expands face-list quads
+// the same way. Uvs run from 0 to the quad's extent, so textures repeat once
+// per voxel on merged faces too.
+void appendQuadVertices(const MeshQuad& quad, std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices);
+
+// The six faces of the cube [0, size) as quads
+void appendBoxQuads(uint32_t size, MaterialId material, std::vector<MeshQuad>& quads);
+
+// Where World builds brick meshes. Compute dispatches mesh_generator.comp,
+// the CPU backends run a BrickMesher on the calling thread and only use the
+// device for the upload, so they keep working without the compute pipeline.
+enum class MeshBackend {
+    Compute,
+    CpuGreedy
+};
+
+// The one voxel thick layer around a brick, taken from its neighbors so
+// faces between bricks can be culled. Only solidity matters for that, so
+// each face is BRICK_SIZE rows of bits: bit u of rows[face * BRICK_SIZE + v]
+// is the voxel across the face at u and v along the next two axes in cyclic
+// order. Uploaded as is after the voxels for mesh_generator.comp.
+struct BrickApron {
+    std::array<uint64_t, 6 * BRICK_SIZE> rows;
+
+    BrickApron() { clear(); }
+    void clear() { rows.fill(0); }
+
+    uint64_t* faceRows(uint32_t face) { return rows.data() + face * BRICK_SIZE; }
+    const uint64_t* faceRows(uint32_t face) const { return rows.data() + face * BRICK_SIZE; }
+};
+
+// CPU mesher for one brick. Input is BRICK_VOLUME material ids, x-fastest
+// like VoxelBrick, and the node-local quads are appended to the output, to
+// be drawn as they are or expanded with appendQuadVertices. Faces toward
+// solid apron voxels are culled, as in the shader.
+// Meshers keep scratch state between calls, each thread needs its own.
+class BrickMesher {
+public:
+    virtual ~BrickMesher() = default;
+    virtual void meshBrick(const MaterialId* voxels, const BrickApron& apron, std::vector<MeshQuad>& quads) = 0;
+};
+
+// The mesher a backend runs, nullptr for Compute
+std::unique_ptr<BrickMesher> createBrickMesher(MeshBackend backend);
+
+// Binary greedy mesher. Solid voxels become one 64-bit mask per column along
+// each axis, so a shift and a mask find the visible faces of a whole column
+// at once. The faces are sorted into per-material planes of bit rows, and
+// rectangles grow a full run of bits at a time, first along the row and then
+// over the following rows holding the same run.
+class GreedyMesher : public BrickMesher {
+public:
+    void meshBrick(const MaterialId* voxels, const BrickApron& apron, std::vector<MeshQuad>& quads) override;
+
+private:
+    static constexpr uint32_t SIZE = BRICK_SIZE;
+
+    // Visible faces of one material and direction. Bit u of rows[d * SIZE + v]
+    // is the face of the voxel at depth d along the face axis, u and v along
+    // the next two axes in cyclic order.
+    struct FacePlanes {
+        MaterialId material;
+        std::array<uint64_t, SIZE * SIZE> rows;
+    };
+
+    std::array<uint64_t, SIZE * SIZE> columns[3];  // Solid bits along each axis, indexed v * SIZE + u
+    std::vector<FacePlanes> planes;                 // Grows to the most materials seen on one face direction
+    size_t usedPlanes = 0;
+
+    FacePlanes& planesFor(MaterialId material);
+    void mergeFaces(uint32_t face, FacePlanes& facePlanes, std::vector<MeshQuad>& quads);
+};
+
+} // namespace voxceleron
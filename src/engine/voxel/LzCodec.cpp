@@ -0,0 +1,151 @@
+#include "LzCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace voxceleron {
+namespace lz {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 0xFFFF;
+constexpr uint32_t HASH_LOG = 14;
+constexpr uint32_t SKIP_SHIFT = 6;      // Step faster through data without matches
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+void writeLength(uint8_t*& op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+}
+
+bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip == end) return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// A match length of 0 marks the final, literal-only sequence
+void writeSequence(uint8_t*& op, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength != 0 ? matchLength - MIN_MATCH : 0;
+    *op++ = static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+    if (literalCount >= 15) {
+        writeLength(op, literalCount - 15);
+    }
+    if (literalCount != 0) {
+        std::memcpy(op, literals, literalCount);
+        op += literalCount;
+    }
+
+    if (matchLength == 0) return;
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    if (matchCode >= 15) {
+        writeLength(op, matchCode - 15);
+    }
+}
+
+} // namespace
+
+size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t compress(const uint8_t* src, size_t size, uint8_t* dst) {
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + size;
+    uint8_t* op = dst;
+
+    // Positions are stored relative to src, stale or colliding entries are
+    // caught by comparing the bytes before a match is taken
+    std::vector<uint32_t> table(size_t(1) << HASH_LOG, 0);
+    while (size >= MIN_MATCH && ip + MIN_MATCH <= end) {
+        uint32_t sequence = read32(ip);
+        uint32_t& slot = table[hash(sequence)];
+        const uint8_t* ref = src + slot;
+        slot = static_cast<uint32_t>(ip - src);
+
+        if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_OFFSET || read32(ref) != sequence) {
+            ip += 1 + ((ip - anchor) >> SKIP_SHIFT);
+            continue;
+        }
+
+        const uint8_t* matchEnd = ip + MIN_MATCH;
+        const uint8_t* refEnd = ref + MIN_MATCH;
+        while (matchEnd < end && *matchEnd == *refEnd) {
+            ++matchEnd;
+            ++refEnd;
+        }
+        writeSequence(op, anchor, ip - anchor, ip - ref, matchEnd - ip);
+        ip = matchEnd;
+        anchor = ip;
+    }
+
+    writeSequence(op, anchor, end - anchor, 0, 0);
+    return op - dst;
+}
+
+bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* end = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* outEnd = dst + dstSize;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(ip, end, literalCount)) return false;
+        if (literalCount > static_cast<size_t>(end - ip) || literalCount > static_cast<size_t>(outEnd - op)) return false;
+        if (literalCount != 0) {
+            std::memcpy(op, ip, literalCount);
+            ip += literalCount;
+            op += literalCount;
+        }
+
+        // Only the final sequence ends right after its literals
+        if (ip == end) break;
+
+        if (end - ip < 2) return false;
+        size_t offset = ip[0] | (size_t(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(ip, end, matchLength)) return false;
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<size_t>(outEnd - op)) return false;
+
+        // Overlapping matches repeat the last offset bytes, so copy forwards
+        const uint8_t* ref = op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(op, ref, matchLength);
+            op += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) {
+                *op++ = ref[i];
+            }
+        }
+    }
+
+    return op == outEnd;
+}
+
+} // namespace lz
+} // namespace voxceleron
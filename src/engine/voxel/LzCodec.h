@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace voxceleron {
+namespace lz {
+
+// Byte-oriented LZ77 codec in the style of LZ4, used to keep cold regions
+// in memory at a fraction of their size.
+//
+// The stream is a series of sequences. Each one is a token byte holding
+// the literal count and match length in its two nibbles, followed by any
+// extra length bytes, the literals, a 16-bit little-endian match offset and
+// any extra match length bytes. A nibble of 15 means more length bytes
+// follow, each adding up to 255. The last sequence carries literals only.
+// Matches are found through a single-entry hash table of 4-byte prefixes,
+// which favours speed over ratio.
+
+// Largest possible output of compress() for size input bytes
+size_t compressBound(size_t size);
+
+// Compress size bytes from src into dst, which must hold compressBound(size)
+// bytes. Returns the number of bytes written.
+size_t compress(const uint8_t* src, size_t size, uint8_t* dst);
+
+// Decompress exactly dstSize bytes. Returns false if the input is malformed
+// or does not decode to exactly dstSize bytes.
+bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+} // namespace lz
+} // namespace voxceleron
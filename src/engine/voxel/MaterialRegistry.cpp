@@ -0,0 +1,57 @@
+#include "MaterialRegistry.h"
+#include <iostream>
+
+namespace voxceleron {
+
+MaterialRegistry::MaterialRegistry() {
+    clear();
+}
+
+MaterialId MaterialRegistry::add(const Material& material) {
+    auto existing = ids.find(material);
+    if (existing != ids.end()) {
+        return existing->second;
+    }
+
+    if (colors.size() > MATERIAL_MAX) {
+        std::cerr << "MaterialRegistry: All " << MATERIAL_MAX << " material ids are in use" << std::endl;
+        return MATERIAL_AIR;
+    }
+
+    colors.push_back(material.color);
+    flags.push_back(material.flags);
+    opacity.push_back(material.opacity);
+    hardness.push_back(material.hardness);
+    MaterialId id = static_cast<MaterialId>(colors.size() - 1);
+    ids.emplace(material, id);
+    return id;
+}
+
+Material MaterialRegistry::get(MaterialId id) const {
+    Material material;
+    material.color = colors[id];
+    material.flags = flags[id];
+    material.opacity = opacity[id];
+    material.hardness = hardness[id];
+    return material;
+}
+
+size_t MaterialRegistry::memoryUsage() const {
+    return colors.capacity() * sizeof(uint32_t) +
+           flags.capacity() * sizeof(uint8_t) +
+           opacity.capacity() * sizeof(uint8_t) +
+           hardness.capacity() * sizeof(float) +
+           ids.size() * (sizeof(Material) + sizeof(MaterialId) + sizeof(void*)) +
+           ids.bucket_count() * sizeof(void*);
+}
+
+void MaterialRegistry::clear() {
+    // Air: invisible, see-through and without resistance
+    colors.assign(1, 0);
+    flags.assign(1, MATERIAL_TRANSPARENT);
+    opacity.assign(1, 0);
+    hardness.assign(1, 0.0f);
+    ids.clear();
+}
+
+} // namespace voxceleron
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "VoxelTypes.h"
+
+namespace voxceleron {
+
+// Material property flags
+enum MaterialFlags : uint8_t {
+    MATERIAL_TRANSPARENT = 1 << 0,  // Neighbors stay visible through it
+    MATERIAL_LIQUID      = 1 << 1,
+    MATERIAL_EMISSIVE    = 1 << 2
+};
+
+// Properties of one material, as passed to and returned from the registry
+struct Material {
+    uint32_t color = 0;         // RGBA, red in the high byte
+    uint8_t flags = 0;          // MaterialFlags
+    uint8_t opacity = 255;
+    float hardness = 1.0f;
+
+    bool operator==(const Material& other) const {
+        return color == other.color && flags == other.flags &&
+               opacity == other.opacity && hardness == other.hardness;
+    }
+};
+
+struct MaterialHash {
+    size_t operator()(const Material& material) const {
+        uint32_t hardnessBits;
+        std::memcpy(&hardnessBits, &material.hardness, sizeof(hardnessBits));
+        return (static_cast<size_t>(material.color) * 73856093u) ^
+               (static_cast<size_t>(hardnessBits) * 19349663u) ^
+               (static_cast<size_t>(material.flags) << 8 | material.opacity);
+    }
+};
+
+// Table of every material voxels can reference by MaterialId.
+//
+// Properties are kept structure-of-arrays, so a pass that only needs one of
+// them (colors for upload, flags for meshing) reads a single dense array.
+// Id 0 is always air. Materials are never removed one by one, ids stay
+// valid until clear().
+class MaterialRegistry {
+public:
+    MaterialRegistry();
+
+    // Id of an identical material if one exists, otherwise a new one.
+    // Returns MATERIAL_AIR once all ids are taken.
+    MaterialId add(const Material& material);
+
+    Material get(MaterialId id) const;
+    uint32_t getColor(MaterialId id) const { return colors[id]; }
+    uint8_t getFlags(MaterialId id) const { return flags[id]; }
+    uint8_t getOpacity(MaterialId id) const { return opacity[id]; }
+    float getHardness(MaterialId id) const { return hardness[id]; }
+
+    // Dense per-id arrays, e.g. for uploading to the GPU
+    const std::vector<uint32_t>& getColors() const { return colors; }
+    const std::vector<uint8_t>& getFlagArray() const { return flags; }
+
+    size_t size() const { return colors.size(); }
+    size_t memoryUsage() const;
+    void clear();
+
+private:
+    std::vector<uint32_t> colors;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> opacity;
+    std::vector<float> hardness;
+    std::unordered_map<Material, MaterialId, MaterialHash> ids;    // Deduplicates add()
+};
+
+} // namespace voxceleron
@@ -0,0 +1,85 @@
+#include "MeshJobPool.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+
+namespace voxceleron {
+
+MeshJobPool::MeshJobPool(MeshBackend backend, uint32_t threadCount)
+    : backend(backend)
+    , running(0)
+    , stopping(false)
+    , completed(nullptr)
+    , pending(0) {
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&MeshJobPool::run, this);
+    }
+}
+
+MeshJobPool::~MeshJobPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    drain([](MeshJob&) {});
+}
+
+void MeshJobPool::submit(std::unique_ptr<MeshJob> job) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(job));
+    }
+    queueReady.notify_one();
+}
+
+void MeshJobPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueIdle.wait(lock, [this]() { return queue.empty() && running == 0; });
+}
+
+void MeshJobPool::run() {
+    std::unique_ptr<BrickMesher> mesher = createBrickMesher(backend);
+    std::vector<MaterialId> voxels(BRICK_VOLUME);
+
+    for (;;) {
+        std::unique_ptr<MeshJob> job;
+        {
+            // Queued jobs still run after stop, so nothing submitted is lost
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+            running++;
+        }
+
+        // Only brick-sized leaves are submitted, collapsed ones hold their value
+        const OctreeNode& node = job->snapshot->getNode(job->nodeIndex);
+        if (node.isUniform()) {
+            std::fill(voxels.begin(), voxels.end(), static_cast<MaterialId>(node.payload));
+        } else {
+            job->snapshot->getBrick(node.payload).decode(voxels.data());
+        }
+        job->snapshot.reset();
+        mesher->meshBrick(voxels.data(), job->apron, job->quads);
+
+        MeshJob* done = job.release();
+        done->next = completed.load(std::memory_order_relaxed);
+        while (!completed.compare_exchange_weak(done->next, done,
+                                                std::memory_order_release, std::memory_order_relaxed)) {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (--running == 0 && queue.empty()) {
+                queueIdle.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace voxceleron
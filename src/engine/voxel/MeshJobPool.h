@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "BrickMesher.h"
+
+namespace voxceleron {
+
+class WorldSnapshot;
+
+// A brick to mesh and, once a worker is done, its mesh. The snapshot keeps
+// the brick unchanged while it is read and is dropped before completion.
+struct MeshJob {
+    uint32_t nodeIndex = INVALID_INDEX;
+    uint32_t ticket = 0;                // Lets the world spot results made stale by later edits
+    glm::ivec3 position = glm::ivec3(0);
+    std::shared_ptr<const WorldSnapshot> snapshot;
+    BrickApron apron;                   // Gathered at submit, from the same state as the snapshot
+    std::vector<MeshQuad> quads;
+    MeshJob* next = nullptr;            // Completion queue link
+};
+
+// Fixed set of worker threads meshing bricks with a CPU backend.
+//
+// Jobs go in through a mutex-guarded queue, only touched once per job.
+// Finished jobs come back through a lock-free stack: workers push with a
+// compare-and-swap and the owning thread takes the whole stack with one
+// exchange, so publishing a mesh never waits on the thread uploading them.
+// Submit and drain from one thread, the world's editing thread.
+class MeshJobPool {
+public:
+    MeshJobPool(MeshBackend backend, uint32_t threadCount);
+    ~MeshJobPool();     // Finishes queued jobs, results not yet drained are dropped
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+    size_t getPendingCount() const { return pending.load(std::memory_order_relaxed); }   // Submitted, not yet drained
+
+    void submit(std::unique_ptr<MeshJob> job);
+
+    // Block until every submitted job is waiting to be drained
+    void waitIdle();
+
+    // Hand finished jobs to visit in completion order, returns how many
+    template<typename Visit>
+    size_t drain(Visit&& visit) {
+        MeshJob* head = completed.exchange(nullptr, std::memory_order_acquire);
+
+        // The stack holds the newest job first
+        MeshJob* ordered = nullptr;
+        while (head) {
+            MeshJob* next = head->next;
+            head->next = ordered;
+            ordered = head;
+            head = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+            std::unique_ptr<MeshJob> job(ordered);
+            ordered = ordered->next;
+            visit(*job);
+            ++count;
+        }
+        pending.fetch_sub(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    MeshJobPool(const MeshJobPool&) = delete;
+    MeshJobPool& operator=(const MeshJobPool&) = delete;
+
+private:
+    MeshBackend backend;
+    std::vector<std::thread> workers;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::condition_variable queueIdle;
+    std::deque<std::unique_ptr<MeshJob>> queue;
+    uint32_t running;       // Jobs taken off the queue and not yet completed
+    bool stopping;
+
+    std::atomic<MeshJob*> completed;
+    std::atomic<size_t> pending;
+
+    void run();
+};
+
+} // namespace voxceleron
@@ -8,51 +8,83 @@
 
 namespace voxceleron {
 
-struct MeshData {
-    VkBuffer vertexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
-    VkBuffer indexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory indexMemory = VK_NULL_HANDLE;
-    uint32_t vertexCount = 0;
-    uint32_t indexCount = 0;
+// Packed mesh vertex, written by every mesh backend and decoded in
+// basic.vert. Positions are node-local in units of node size / BRICK_SIZE,
+// so each mesh spans 0 to BRICK_SIZE: voxels for a brick, a scaled-up box
+// for a collapsed node. Faces are numbered 2 * axis for the low side and
+// 2 * axis + 1 for the high side and give the normal; uv runs 0 to the
+// quad's extent.
+//   position: x bits 0-6, y bits 7-13, z bits 14-20, face bits 21-23
+//   attributes: material bits 0-15, u bits 16-22, v bits 23-29
+struct MeshVertex {
+    uint32_t position;
+    uint32_t attributes;
+
+    static MeshVertex pack(const glm::ivec3& pos, uint32_t face, uint32_t material, uint32_t u, uint32_t v) {
+        return MeshVertex{
+            uint32_t(pos.x) | (uint32_t(pos.y) << 7) | (uint32_t(pos.z) << 14) | (face << 21),
+            material | (u << 16) | (v << 23)
+        };
+    }
+    glm::ivec3 getPosition() const {
+        return glm::ivec3(position & 0x7F, (position >> 7) & 0x7F, (position >> 14) & 0x7F);
+    }
+    uint32_t getFace() const { return (position >> 21) & 0x7; }
+    uint32_t getMaterial() const { return attributes & 0xFFFF; }
+    glm::uvec2 getUv() const { return glm::uvec2((attributes >> 16) & 0x7F, (attributes >> 23) & 0x7F); }
 };
 
-// Forward declaration
-class OctreeNode;
+static_assert(sizeof(MeshVertex) == 8, "MeshVertex must stay within 8 bytes");
+
+// One greedy quad of a face-list mesh, in MeshVertex's units and face
+// numbering. It covers the given face of the voxels from origin to origin +
+// (width, height) along the face's other two axes in cyclic order, so the
+// high side of a voxel at x draws at x + 1. face.vert pulls the quads
+// straight from a storage buffer, six vertices each and no index buffer.
+//   position: x bits 0-6, y bits 7-13, z bits 14-20, face bits 21-23, width - 1 bits 24-29
+//   attributes: material bits 0-15, height - 1 bits 16-21
+struct MeshQuad {
+    uint32_t position;
+    uint32_t attributes;
 
-struct LeafData {
-    std::vector<uint32_t> data;  // Packed voxel data
-    std::vector<uint8_t> runs;   // RLE compressed runs
+    static MeshQuad pack(const glm::ivec3& origin, uint32_t face, uint32_t width, uint32_t height, uint32_t material) {
+        return MeshQuad{
+            uint32_t(origin.x) | (uint32_t(origin.y) << 7) | (uint32_t(origin.z) << 14) |
+                (face << 21) | ((width - 1) << 24),
+            material | ((height - 1) << 16)
+        };
+    }
+    glm::ivec3 getOrigin() const {
+        return glm::ivec3(position & 0x7F, (position >> 7) & 0x7F, (position >> 14) & 0x7F);
+    }
+    uint32_t getFace() const { return (position >> 21) & 0x7; }
+    uint32_t getWidth() const { return ((position >> 24) & 0x3F) + 1; }
+    uint32_t getHeight() const { return ((attributes >> 16) & 0x3F) + 1; }
+    uint32_t getMaterial() const { return attributes & 0xFFFF; }
 };
 
-struct InternalData {
-    std::array<std::unique_ptr<OctreeNode>, 8> children;
+static_assert(sizeof(MeshQuad) == 8, "MeshQuad must stay within 8 bytes");
+
+// How CPU-built meshes reach the GPU. Indexed expands each quad into four
+// MeshVertex and six indices in per-mesh buffers; FaceList keeps the quads
+// in one shared buffer the vertex shader reads directly.
+enum class MeshFormat {
+    Indexed,
+    FaceList
 };
 
-class OctreeNode {
-public:
-    glm::ivec3 position{0};      // Position in world space
-    uint32_t size{0};            // Size of this node (power of 2)
-    uint32_t level{0};           // Level in octree (0 = root)
-    bool isLeaf{true};           // Is this a leaf node?
-    bool needsUpdate{false};     // Does this node need mesh update?
-    bool isOptimized{false};     // Has this node been optimized?
-    uint32_t optimizedValue{0};  // Value for optimized nodes
-    uint8_t childMask{0};        // Bitmask of active children
-
-    // Mesh data
-    std::vector<MeshData> meshes;
-
-    // Node data (union to save memory)
-    union NodeData {
-        LeafData leaf;
-        InternalData internal;
-
-        NodeData() : leaf() {}  // Initialize as leaf data by default
-        ~NodeData() {}         // Empty destructor
-    } nodeData;
-
-    const std::vector<MeshData>& getMeshes() const { return meshes; }
+// GPU mesh state for an octree node, stored in World's side table by node index
+struct MeshData {
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;  // 16-bit when every vertex fits
+    uint32_t firstQuad = 0;         // Face-list meshes only, their range of the shared quad buffer
+    uint32_t quadCount = 0;
+    VkDeviceSize memorySize = 0;   // Bytes held by the mesh's buffers or quad range
 };
 
-} // namespace voxceleron
\ No newline at end of file
+} // namespace voxceleron
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <glm/glm.hpp>
+#include "VoxelTypes.h"
+
+namespace voxceleron {
+
+// A node as seen during traversal, with its bounds derived on the way down
+struct NodeVisit {
+    uint32_t nodeIndex;
+    glm::ivec3 position;
+    uint32_t size;
+};
+
+// Post-order callback for walks that only need pre-order
+struct NoPostVisit {
+    void operator()(const NodeVisit&) const {}
+};
+
+// Written field by field into the stack slot, building a temporary here
+// measurably slows down the walk
+inline void childVisit(const NodeVisit& parent, const OctreeNode& node, uint32_t octant, NodeVisit& child) {
+    uint32_t childSize = parent.size >> 1;
+    child.nodeIndex = node.child(octant);
+    child.position.x = parent.position.x + ((octant & 1) ? childSize : 0);
+    child.position.y = parent.position.y + ((octant & 2) ? childSize : 0);
+    child.position.z = parent.position.z + ((octant & 4) ? childSize : 0);
+    child.size = childSize;
+}
+
+// Leaf containing pos below a node spanning size voxels, or INVALID_INDEX
+// when the path ends at a missing child. Nodes are aligned to their size,
+// so each octant is a single coordinate bit.
+inline uint32_t findLeaf(const NodePool& nodes, uint32_t nodeIndex, uint32_t size, const glm::ivec3& pos) {
+    while (nodeIndex != INVALID_INDEX && !nodes[nodeIndex].isLeaf()) {
+        size >>= 1;
+        uint32_t octant = ((pos.x & size) ? 1u : 0u) | ((pos.y & size) ? 2u : 0u) | ((pos.z & size) ? 4u : 0u);
+        const OctreeNode& node = nodes[nodeIndex];
+        nodeIndex = node.hasChild(octant) ? node.child(octant) : INVALID_INDEX;
+    }
+    return nodeIndex;
+}
+
+// Depth-first octree walk over an explicit fixed-size stack. Callbacks are
+// template parameters, so each walk compiles to a plain loop without
+// indirect calls, recursion or heap allocation.
+//
+// pre(visit) runs before a node's children and returns false to prune the
+// subtree; post(visit) runs after them. Children are visited in Morton order
+// with each octant XORed by childOrder, so passing the octant nearest the
+// viewer gives front-to-back order. Callbacks may restructure the node they
+// are visiting (its children are read only once pre returns) but must not
+// touch nodes that are still on the stack.
+template<uint32_t MaxDepth, typename Pre, typename Post = NoPostVisit>
+void traverseOctree(const NodePool& nodes, const NodeVisit& root,
+                    Pre&& pre, Post&& post = Post(), uint32_t childOrder = 0) {
+    if (root.nodeIndex == INVALID_INDEX) return;
+
+    // Visits are pushed in reverse so they pop in order. A node that still
+    // needs its post callback goes back on the stack, under its children,
+    // with the top bit of its size set.
+    constexpr bool HasPost = !std::is_same<std::decay_t<Post>, NoPostVisit>::value;
+    constexpr uint32_t POST_VISIT = 0x80000000u;
+    std::array<NodeVisit, 8 * MaxDepth + 1> stack;
+    uint32_t top = 0;
+    stack[top++] = root;
+
+    while (top > 0) {
+        NodeVisit visit = stack[--top];
+        if (HasPost && (visit.size & POST_VISIT)) {
+            visit.size &= ~POST_VISIT;
+            post(visit);
+            continue;
+        }
+        if (!pre(visit)) continue;
+
+        if (HasPost) {
+            stack[top] = visit;
+            stack[top++].size |= POST_VISIT;
+        }
+
+        const OctreeNode& node = nodes[visit.nodeIndex];
+        if (node.isLeaf()) continue;
+        for (int i = 7; i >= 0; --i) {
+            uint32_t octant = static_cast<uint32_t>(i) ^ childOrder;
+            if (node.hasChild(octant)) {
+                childVisit(visit, node, octant, stack[top++]);
+            }
+        }
+    }
+}
+
+} // namespace voxceleron
@@ -0,0 +1,370 @@
+#include "PaletteBrick.h"
+#include <algorithm>
+
+namespace voxceleron {
+
+namespace {
+
+uint32_t hashMaterial(MaterialId material) {
+    uint32_t h = material * 0x9E3779B1u;
+    return h ^ (h >> 16);
+}
+
+// Expand one width of palette indices; Bits is a compile-time constant so
+// the inner loop unrolls into plain shifts and masks
+template<uint32_t Bits, uint32_t Volume>
+void decodeIndices(const uint64_t* words, const MaterialId* palette, MaterialId* out) {
+    constexpr uint32_t PER_WORD = 64 / Bits;
+    constexpr uint64_t MASK = (uint64_t(1) << Bits) - 1;
+    constexpr uint32_t WORD_COUNT = Volume / PER_WORD;
+
+    for (uint32_t w = 0; w < WORD_COUNT; ++w) {
+        uint64_t word = words[w];
+        for (uint32_t k = 0; k < PER_WORD; ++k) {
+            *out++ = palette[word & MASK];
+            word >>= Bits;
+        }
+    }
+}
+
+} // namespace
+
+template<uint32_t SizeLog2>
+BasicPaletteBrick<SizeLog2>::BasicPaletteBrick(MaterialId material)
+    : solidCount(0)
+    , lookupTombstones(0)
+    , liveEntries(0)
+    , bitsPerVoxel(0)
+    , cachedHash(0)
+    , hashValid(false) {
+    fill(material);
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::fill(MaterialId material) {
+    palette.assign(1, material);
+    refCounts.assign(1, VOLUME);
+    freeEntries.clear();
+    indices.clear();
+    indices.shrink_to_fit();
+    lookup.clear();
+    lookupTombstones = 0;
+    liveEntries = 1;
+    bitsPerVoxel = 0;
+
+    bool solid = isSolidVoxel(material);
+    occupancy.fill(solid ? ~uint64_t(0) : 0);
+    solidCount = solid ? VOLUME : 0;
+    hashValid = false;
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::set(uint32_t index, MaterialId material) {
+    uint32_t oldEntry = bitsPerVoxel ? readIndex(index) : 0;
+    if (palette[oldEntry] == material) return;
+    hashValid = false;
+
+    bool solid = isSolidVoxel(material);
+    if (solid != isSolidVoxel(palette[oldEntry])) {
+        occupancy[index >> 6] ^= uint64_t(1) << (index & 63);
+        solidCount += solid ? 1 : -1;
+    }
+
+    uint32_t entry = findEntry(material);
+    if (entry == EMPTY_LOOKUP) {
+        // May widen the indices, so oldEntry is re-read afterwards
+        entry = addEntry(material);
+        oldEntry = readIndex(index);
+    } else {
+        refCounts[entry]++;
+    }
+
+    writeIndex(index, entry);
+    releaseEntry(oldEntry);
+}
+
+template<uint32_t SizeLog2>
+bool BasicPaletteBrick<SizeLog2>::isFaceSolid(uint32_t face) const {
+    if (solidCount == VOLUME) return true;
+    if (solidCount == 0) return false;
+
+    // A word holds 64 / SIZE whole x rows. x faces are one bit per row in every
+    // word, y faces one row in the first or last word of each z slice and z
+    // faces the whole words of the first or last slice.
+    constexpr uint32_t SLICE_WORDS = SIZE * SIZE / 64;
+    constexpr uint64_t ROW = SIZE == 64 ? ~uint64_t(0) : (uint64_t(1) << SIZE) - 1;
+    constexpr uint64_t ROW_STARTS = ~uint64_t(0) / ROW;     // Bit 0 of every row in a word
+    uint64_t mask = ~uint64_t(0);
+    uint32_t first = 0, step = 1, count = OCCUPANCY_WORDS;
+    switch (face) {
+        case 0: mask = ROW_STARTS; break;
+        case 1: mask = ROW_STARTS << (SIZE - 1); break;
+        case 2: mask = ROW; step = SLICE_WORDS; count = SIZE; break;
+        case 3: mask = ROW << (64 - SIZE); first = SLICE_WORDS - 1; step = SLICE_WORDS; count = SIZE; break;
+        case 4: count = SLICE_WORDS; break;
+        default: first = OCCUPANCY_WORDS - SLICE_WORDS; count = SLICE_WORDS; break;
+    }
+    for (uint32_t i = 0, w = first; i < count; ++i, w += step) {
+        if ((occupancy[w] & mask) != mask) return false;
+    }
+    return true;
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::getFaceOccupancy(uint32_t face, uint64_t* rows) const {
+    constexpr uint64_t ROW = SIZE == 64 ? ~uint64_t(0) : (uint64_t(1) << SIZE) - 1;
+    const uint32_t axis = face >> 1;
+    const uint32_t depth = (face & 1) ? SIZE - 1 : 0;
+    if (solidCount == VOLUME || solidCount == 0) {
+        std::fill_n(rows, SIZE, solidCount == 0 ? 0 : ROW);
+        return;
+    }
+
+    if (axis == 2) {
+        // z faces are the x rows of one slice, u is x and v is y
+        for (uint32_t y = 0; y < SIZE; ++y) {
+            uint32_t index = Layout::index(0, y, depth);
+            rows[y] = (occupancy[index >> 6] >> (index & 63)) & ROW;
+        }
+        return;
+    }
+
+    // x and y faces gather one bit per row
+    for (uint32_t v = 0; v < SIZE; ++v) {
+        uint64_t bits = 0;
+        for (uint32_t u = 0; u < SIZE; ++u) {
+            uint32_t index = axis == 0 ? Layout::index(depth, u, v) : Layout::index(v, depth, u);
+            bits |= uint64_t(isSolid(index)) << u;
+        }
+        rows[v] = bits;
+    }
+}
+
+template<uint32_t SizeLog2>
+MaterialId BasicPaletteBrick<SizeLog2>::uniformValue() const {
+    for (size_t i = 0; i < palette.size(); ++i) {
+        if (refCounts[i] != 0) return palette[i];
+    }
+    return MATERIAL_AIR;
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::decode(MaterialId* out) const {
+    switch (bitsPerVoxel) {
+        case 0:  std::fill_n(out, VOLUME, palette[0]); break;
+        case 1:  decodeIndices<1, VOLUME>(indices.data(), palette.data(), out); break;
+        case 2:  decodeIndices<2, VOLUME>(indices.data(), palette.data(), out); break;
+        case 4:  decodeIndices<4, VOLUME>(indices.data(), palette.data(), out); break;
+        case 8:  decodeIndices<8, VOLUME>(indices.data(), palette.data(), out); break;
+        default: decodeIndices<16, VOLUME>(indices.data(), palette.data(), out); break;
+    }
+}
+
+template<uint32_t SizeLog2>
+uint64_t BasicPaletteBrick<SizeLog2>::contentHash() const {
+    if (hashValid) return cachedHash;
+
+    // FNV-1a over the values, the palette order differs between equal bricks
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t i = 0; i < VOLUME; ++i) {
+        hash = (hash ^ get(i)) * 0x100000001b3ull;
+    }
+    cachedHash = hash;
+    hashValid = true;
+    return hash;
+}
+
+template<uint32_t SizeLog2>
+bool BasicPaletteBrick<SizeLog2>::sameVoxels(const BasicPaletteBrick& other) const {
+    if (solidCount != other.solidCount || liveEntries != other.liveEntries) return false;
+    for (uint32_t i = 0; i < VOLUME; ++i) {
+        if (get(i) != other.get(i)) return false;
+    }
+    return true;
+}
+
+template<uint32_t SizeLog2>
+size_t BasicPaletteBrick<SizeLog2>::memoryUsage() const {
+    return sizeof(BasicPaletteBrick) +
+           palette.capacity() * sizeof(MaterialId) +
+           refCounts.capacity() * sizeof(uint32_t) +
+           freeEntries.capacity() * sizeof(uint32_t) +
+           indices.capacity() * sizeof(uint64_t) +
+           lookup.capacity() * sizeof(uint32_t);
+}
+
+template<uint32_t SizeLog2>
+uint32_t BasicPaletteBrick<SizeLog2>::bitsForEntries(uint32_t entries) {
+    if (entries <= 1) return 0;
+    if (entries <= 2) return 1;
+    if (entries <= 4) return 2;
+    if (entries <= 16) return 4;
+    if (entries <= 256) return 8;
+    return 16;      // Every material id fits
+}
+
+template<uint32_t SizeLog2>
+uint32_t BasicPaletteBrick<SizeLog2>::findEntry(MaterialId material) const {
+    if (lookup.empty()) {
+        // Small palettes are cheaper to scan than to hash
+        for (size_t i = 0; i < palette.size(); ++i) {
+            if (palette[i] == material && refCounts[i] != 0) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        return EMPTY_LOOKUP;
+    }
+
+    uint32_t slot = lookupSlot(material);
+    return lookup[slot] < DELETED_LOOKUP ? lookup[slot] : EMPTY_LOOKUP;
+}
+
+// Adds a palette entry already counting the voxel about to reference it
+template<uint32_t SizeLog2>
+uint32_t BasicPaletteBrick<SizeLog2>::addEntry(MaterialId material) {
+    uint32_t entry;
+    if (!freeEntries.empty()) {
+        entry = freeEntries.back();
+        freeEntries.pop_back();
+        palette[entry] = material;
+        refCounts[entry] = 1;
+    } else {
+        uint64_t capacity = uint64_t(1) << bitsPerVoxel;
+        if (palette.size() >= capacity) {
+            repack(bitsForEntries(static_cast<uint32_t>(palette.size()) + 1));
+        }
+        entry = static_cast<uint32_t>(palette.size());
+        palette.push_back(material);
+        refCounts.push_back(1);
+    }
+    liveEntries++;
+
+    if (lookup.empty() && palette.size() > LINEAR_SEARCH_LIMIT) {
+        rebuildLookup();
+    } else if (!lookup.empty()) {
+        insertLookup(entry);
+    }
+    return entry;
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::releaseEntry(uint32_t entry) {
+    if (--refCounts[entry] != 0) return;
+
+    liveEntries--;
+    freeEntries.push_back(entry);
+    if (!lookup.empty()) {
+        eraseLookup(entry);
+    }
+
+    // Shrink once the live entries fit comfortably in a narrower width, the
+    // slack keeps a single value flipping back and forth from repacking
+    if (liveEntries > 1 && bitsForEntries(liveEntries * 2) < bitsPerVoxel) {
+        repack(bitsForEntries(liveEntries));
+    }
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::repack(uint32_t newBits) {
+    // Drop free slots and renumber the live entries
+    std::vector<uint32_t> remap(palette.size(), 0);
+    std::vector<MaterialId> newPalette;
+    std::vector<uint32_t> newRefCounts;
+    newPalette.reserve(liveEntries + 1);
+    newRefCounts.reserve(liveEntries + 1);
+    for (size_t i = 0; i < palette.size(); ++i) {
+        if (refCounts[i] != 0) {
+            remap[i] = static_cast<uint32_t>(newPalette.size());
+            newPalette.push_back(palette[i]);
+            newRefCounts.push_back(refCounts[i]);
+        }
+    }
+
+    std::vector<uint64_t> newIndices((size_t(VOLUME) * newBits + 63) / 64, 0);
+    if (newBits != 0) {
+        for (uint32_t i = 0; i < VOLUME; ++i) {
+            uint32_t entry = bitsPerVoxel ? remap[readIndex(i)] : 0;
+            uint32_t bit = i * newBits;
+            newIndices[bit >> 6] |= uint64_t(entry) << (bit & 63);
+        }
+    }
+
+    palette.swap(newPalette);
+    refCounts.swap(newRefCounts);
+    indices.swap(newIndices);
+    std::vector<uint32_t>().swap(freeEntries);
+    bitsPerVoxel = newBits;
+
+    if (palette.size() > LINEAR_SEARCH_LIMIT) {
+        rebuildLookup();
+    } else {
+        lookup.clear();
+        lookup.shrink_to_fit();
+        lookupTombstones = 0;
+    }
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::rebuildLookup() {
+    size_t size = 64;
+    while (size < palette.size() * 2) {
+        size <<= 1;
+    }
+    lookup.assign(size, EMPTY_LOOKUP);
+    lookupTombstones = 0;
+
+    for (size_t i = 0; i < palette.size(); ++i) {
+        if (refCounts[i] != 0) {
+            insertLookup(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::insertLookup(uint32_t entry) {
+    // Keep the load factor (including tombstones) at or below one half
+    if ((palette.size() + lookupTombstones) * 2 > lookup.size()) {
+        rebuildLookup();  // Picks up the new entry as well
+        return;
+    }
+
+    uint32_t mask = static_cast<uint32_t>(lookup.size() - 1);
+    uint32_t slot = hashMaterial(palette[entry]) & mask;
+    while (lookup[slot] < DELETED_LOOKUP) {
+        slot = (slot + 1) & mask;
+    }
+    if (lookup[slot] == DELETED_LOOKUP) {
+        lookupTombstones--;
+    }
+    lookup[slot] = entry;
+}
+
+template<uint32_t SizeLog2>
+void BasicPaletteBrick<SizeLog2>::eraseLookup(uint32_t entry) {
+    uint32_t slot = lookupSlot(palette[entry]);
+    if (lookup[slot] == entry) {
+        lookup[slot] = DELETED_LOOKUP;
+        lookupTombstones++;
+    }
+}
+
+template<uint32_t SizeLog2>
+uint32_t BasicPaletteBrick<SizeLog2>::lookupSlot(MaterialId material) const {
+    // Returns the slot holding material, or the empty slot ending its probe chain
+    uint32_t mask = static_cast<uint32_t>(lookup.size() - 1);
+    uint32_t slot = hashMaterial(material) & mask;
+    while (lookup[slot] != EMPTY_LOOKUP) {
+        if (lookup[slot] != DELETED_LOOKUP && palette[lookup[slot]] == material) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+template class BasicPaletteBrick<3>;
+template class BasicPaletteBrick<4>;
+template class BasicPaletteBrick<5>;
+template class BasicPaletteBrick<6>;
+
+} // namespace voxceleron
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "VoxelTypes.h"
+
+namespace voxceleron {
+
+// Palette-compressed brick of 2^(3 * SizeLog2) material ids.
+//
+// Each distinct material is stored once in the palette and every voxel
+// holds an index into it, using 0, 1, 2, 4, 8 or 16 bits. Widths are powers
+// of two so an index never straddles a 64-bit word and get/set stay O(1).
+// The width grows when the palette fills up and shrinks again once enough
+// entries fall out of use.
+//
+// Alongside the indices the brick keeps an occupancy mask, one bit per voxel
+// in the same x-fastest order, set for solid voxels. Rows are at most 64
+// voxels, so a 64-bit word covers 64 / SIZE whole x rows and every z slice
+// starts on a word boundary.
+//
+// Member definitions live in PaletteBrick.cpp, instantiated for every edge
+// length BrickLayout allows; the world uses PaletteBrick, the configured one.
+template<uint32_t SizeLog2>
+class BasicPaletteBrick {
+public:
+    using Layout = BrickLayout<SizeLog2>;
+    static constexpr uint32_t SIZE = Layout::SIZE;
+    static constexpr uint32_t VOLUME = Layout::VOLUME;
+    static constexpr uint32_t OCCUPANCY_WORDS = VOLUME / 64;
+
+    explicit BasicPaletteBrick(MaterialId material = MATERIAL_AIR);
+
+    MaterialId get(uint32_t index) const {
+        if (bitsPerVoxel == 0) return palette[0];
+        return palette[readIndex(index)];
+    }
+
+    void set(uint32_t index, MaterialId material);
+
+    // Reset every voxel to a single value
+    void fill(MaterialId material);
+
+    // Expand into VOLUME material ids, x-fastest like VoxelBrick
+    void decode(MaterialId* out) const;
+
+    // Hash of the voxel values, independent of palette layout. Computed on
+    // first use and kept until the next set or fill, so deduplication passes
+    // only rehash bricks that were edited since the last one.
+    uint64_t contentHash() const;
+
+    // Voxel-by-voxel comparison, tells hash collisions apart
+    bool sameVoxels(const BasicPaletteBrick& other) const;
+
+    // Live materials and how many voxels hold each, in palette order
+    template<typename Visit>
+    void forEachMaterial(Visit&& visit) const {
+        for (size_t i = 0; i < palette.size(); ++i) {
+            if (refCounts[i] != 0) visit(palette[i], refCounts[i]);
+        }
+    }
+
+    // A brick whose palette has collapsed to one live entry
+    bool isUniform() const { return liveEntries == 1; }
+    MaterialId uniformValue() const;
+
+    // Occupancy. A face is solid when every voxel touching it is, faces are
+    // numbered 2 * axis for the low side and 2 * axis + 1 for the high side.
+    const std::array<uint64_t, OCCUPANCY_WORDS>& getOccupancy() const { return occupancy; }
+    bool isSolid(uint32_t index) const { return (occupancy[index >> 6] >> (index & 63)) & 1; }
+    uint32_t getSolidCount() const { return solidCount; }
+    bool isEmpty() const { return solidCount == 0; }
+    bool isFull() const { return solidCount == VOLUME; }
+    bool isFaceSolid(uint32_t face) const;
+
+    // Solid voxels of the layer touching a face as SIZE rows: bit u of
+    // rows[v] is the voxel at u and v along the next two axes in cyclic order
+    void getFaceOccupancy(uint32_t face, uint64_t* rows) const;
+
+    uint32_t getBitsPerVoxel() const { return bitsPerVoxel; }
+    uint32_t getPaletteSize() const { return liveEntries; }
+    size_t memoryUsage() const;
+
+private:
+    static constexpr uint32_t LINEAR_SEARCH_LIMIT = 16;  // Hash lookups above this palette size
+    static constexpr uint32_t EMPTY_LOOKUP = 0xFFFFFFFF;
+    static constexpr uint32_t DELETED_LOOKUP = 0xFFFFFFFE;
+
+    std::vector<MaterialId> palette;    // Material per entry
+    std::vector<uint32_t> refCounts;    // Voxels referencing each entry, 0 = free slot
+    std::vector<uint32_t> freeEntries;  // Palette slots available for reuse
+    std::vector<uint64_t> indices;      // bitsPerVoxel-wide palette indices
+    std::vector<uint32_t> lookup;       // Open-addressing value -> entry table for large palettes
+    std::array<uint64_t, OCCUPANCY_WORDS> occupancy;
+    uint32_t solidCount;
+    uint32_t lookupTombstones;
+    uint32_t liveEntries;
+    uint32_t bitsPerVoxel;
+    mutable uint64_t cachedHash;
+    mutable bool hashValid;
+
+    uint32_t readIndex(uint32_t index) const {
+        uint32_t bit = index * bitsPerVoxel;
+        uint64_t mask = (uint64_t(1) << bitsPerVoxel) - 1;
+        return static_cast<uint32_t>((indices[bit >> 6] >> (bit & 63)) & mask);
+    }
+
+    void writeIndex(uint32_t index, uint32_t entry) {
+        uint32_t bit = index * bitsPerVoxel;
+        uint64_t mask = ((uint64_t(1) << bitsPerVoxel) - 1) << (bit & 63);
+        uint64_t& word = indices[bit >> 6];
+        word = (word & ~mask) | ((uint64_t(entry) << (bit & 63)) & mask);
+    }
+
+    static uint32_t bitsForEntries(uint32_t entries);
+
+    uint32_t findEntry(MaterialId material) const;
+    uint32_t addEntry(MaterialId material);
+    void releaseEntry(uint32_t entry);
+    void repack(uint32_t newBits);
+    void rebuildLookup();
+    void insertLookup(uint32_t entry);
+    void eraseLookup(uint32_t entry);
+    uint32_t lookupSlot(MaterialId material) const;
+};
+
+using PaletteBrick = BasicPaletteBrick<BRICK_SIZE_LOG2>;
+
+} // namespace voxceleron
@@ -0,0 +1,68 @@
+#include "RangeAllocator.h"
+#include <cassert>
+#include <iterator>
+
+namespace voxceleron {
+
+RangeAllocator::RangeAllocator()
+    : capacity(0)
+    , used(0) {
+}
+
+uint32_t RangeAllocator::allocate(uint32_t count) {
+    assert(count > 0);
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < count) continue;
+
+        // Take the front of the range, the rest stays free
+        uint32_t first = it->first;
+        uint32_t remaining = it->second - count;
+        freeRanges.erase(it);
+        if (remaining > 0) {
+            freeRanges.emplace(first + count, remaining);
+        }
+        used += count;
+        return first;
+    }
+    return INVALID_INDEX;
+}
+
+void RangeAllocator::release(uint32_t first, uint32_t count) {
+    assert(count > 0 && first + count <= capacity && used >= count);
+    used -= count;
+
+    auto next = freeRanges.lower_bound(first);
+    assert(next == freeRanges.end() || next->first >= first + count);
+    if (next != freeRanges.end() && next->first == first + count) {
+        count += next->second;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+        auto prev = std::prev(next);
+        assert(prev->first + prev->second <= first);
+        if (prev->first + prev->second == first) {
+            prev->second += count;
+            return;
+        }
+    }
+    freeRanges.emplace_hint(next, first, count);
+}
+
+void RangeAllocator::grow(uint32_t newCapacity) {
+    if (newCapacity <= capacity) return;
+    uint32_t tail = capacity;
+    uint32_t added = newCapacity - capacity;
+    capacity = newCapacity;
+
+    // Joins a free range ending at the old capacity
+    used += added;
+    release(tail, added);
+}
+
+void RangeAllocator::clear() {
+    freeRanges.clear();
+    capacity = 0;
+    used = 0;
+}
+
+} // namespace voxceleron
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include "VoxelTypes.h"
+
+namespace voxceleron {
+
+// First-fit allocator of index ranges in [0, capacity), for suballocating
+// one large buffer. Free ranges are kept ordered by start, and a released
+// range merges with free neighbors on both sides so fragmentation does not
+// pile up as meshes of varying size come and go.
+class RangeAllocator {
+public:
+    RangeAllocator();
+
+    // First index of a free range of count entries, INVALID_INDEX if no free
+    // range is long enough. Count must be nonzero.
+    uint32_t allocate(uint32_t count);
+
+    // Return a range handed out by allocate
+    void release(uint32_t first, uint32_t count);
+
+    // Extend the capacity, the new tail becomes free
+    void grow(uint32_t capacity);
+
+    void clear();
+
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getUsed() const { return used; }
+
+private:
+    std::map<uint32_t, uint32_t> freeRanges;    // First index to length
+    uint32_t capacity;
+    uint32_t used;
+};
+
+} // namespace voxceleron
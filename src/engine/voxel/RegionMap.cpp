@@ -0,0 +1,92 @@
+#include "RegionMap.h"
+
+namespace voxceleron {
+
+RegionMap::RegionMap()
+    : slots(MIN_CAPACITY, Slot{glm::ivec3(0), INVALID_INDEX, 0})
+    , count(0) {}
+
+uint32_t RegionMap::hash(const glm::ivec3& coord) {
+    // Mix all three coordinates so neighbouring regions scatter across the table
+    uint64_t h = static_cast<uint32_t>(coord.x) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint32_t>(coord.y) * 0xC2B2AE3D27D4EB4Full;
+    h ^= static_cast<uint32_t>(coord.z) * 0x165667B19E3779F9ull;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+size_t RegionMap::slotOf(const glm::ivec3& coord) const {
+    size_t mask = slots.size() - 1;
+    size_t i = home(coord);
+    while (slots[i].rootIndex != INVALID_INDEX && slots[i].coord != coord) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+uint32_t RegionMap::find(const glm::ivec3& coord) const {
+    return slots[slotOf(coord)].rootIndex;
+}
+
+uint32_t RegionMap::touch(const glm::ivec3& coord, uint32_t frame) {
+    Slot& slot = slots[slotOf(coord)];
+    if (slot.rootIndex != INVALID_INDEX) {
+        slot.lastAccess = frame;
+    }
+    return slot.rootIndex;
+}
+
+uint32_t RegionMap::lastAccess(const glm::ivec3& coord) const {
+    return slots[slotOf(coord)].lastAccess;
+}
+
+void RegionMap::insert(const glm::ivec3& coord, uint32_t rootIndex) {
+    if ((count + 1) * 2 > slots.size()) {
+        rehash(slots.size() * 2);
+    }
+
+    Slot& slot = slots[slotOf(coord)];
+    if (slot.rootIndex == INVALID_INDEX) {
+        slot = Slot{coord, rootIndex, 0};
+        count++;
+    } else {
+        slot.rootIndex = rootIndex;
+    }
+}
+
+bool RegionMap::erase(const glm::ivec3& coord) {
+    size_t mask = slots.size() - 1;
+    size_t hole = slotOf(coord);
+    if (slots[hole].rootIndex == INVALID_INDEX) return false;
+
+    // Backward-shift deletion: pull later entries of the chain into the hole
+    // unless their home slot lies cyclically between the hole and themselves
+    for (size_t i = (hole + 1) & mask; slots[i].rootIndex != INVALID_INDEX; i = (i + 1) & mask) {
+        size_t slotHome = home(slots[i].coord);
+        if (((i - slotHome) & mask) >= ((i - hole) & mask)) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole].rootIndex = INVALID_INDEX;
+    count--;
+    return true;
+}
+
+void RegionMap::clear() {
+    std::vector<Slot>(MIN_CAPACITY, Slot{glm::ivec3(0), INVALID_INDEX, 0}).swap(slots);
+    count = 0;
+}
+
+void RegionMap::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{glm::ivec3(0), INVALID_INDEX, 0});
+    old.swap(slots);
+    for (const Slot& slot : old) {
+        if (slot.rootIndex != INVALID_INDEX) {
+            slots[slotOf(slot.coord)] = slot;
+        }
+    }
+}
+
+} // namespace voxceleron
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "VoxelTypes.h"
+
+namespace voxceleron {
+
+// Open-addressing hash map from region coordinate to the root node of that
+// region's octree.
+//
+// Linear probing over a power-of-two table kept at most half full, so a
+// lookup touches one or two cache lines on average. Deletion shifts the
+// following entries of the probe chain back instead of leaving tombstones,
+// which keeps lookups fast under heavy load/unload churn.
+class RegionMap {
+public:
+    RegionMap();
+
+    // Root index of the region, or INVALID_INDEX if it is not loaded
+    uint32_t find(const glm::ivec3& coord) const;
+
+    // Like find(), also recording frame as the region's last access
+    uint32_t touch(const glm::ivec3& coord, uint32_t frame);
+    uint32_t lastAccess(const glm::ivec3& coord) const;
+
+    // Add or replace the root of a region
+    void insert(const glm::ivec3& coord, uint32_t rootIndex);
+
+    // Remove a region, returns false if it was not present
+    bool erase(const glm::ivec3& coord);
+
+    void clear();
+
+    // Visit every region as fn(coord, rootIndex). The map must not be
+    // modified during the visit.
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const Slot& slot : slots) {
+            if (slot.rootIndex != INVALID_INDEX) {
+                fn(slot.coord, slot.rootIndex);
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    size_t memoryUsage() const { return slots.capacity() * sizeof(Slot); }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 64;
+
+    struct Slot {
+        glm::ivec3 coord;
+        uint32_t rootIndex;     // INVALID_INDEX marks an empty slot
+        uint32_t lastAccess;
+    };
+
+    std::vector<Slot> slots;
+    size_t count;
+
+    static uint32_t hash(const glm::ivec3& coord);
+    size_t home(const glm::ivec3& coord) const { return hash(coord) & (slots.size() - 1); }
+    size_t slotOf(const glm::ivec3& coord) const;   // Index of the region's slot, or of the empty slot ending its chain
+    void rehash(size_t capacity);
+};
+
+} // namespace voxceleron
@@ -0,0 +1,100 @@
+#include "SlabAllocator.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace voxceleron {
+
+namespace {
+
+constexpr size_t DEFAULT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+size_t hugePageSize() {
+#ifdef _WIN32
+    size_t size = GetLargePageMinimum();
+    return size != 0 ? size : DEFAULT_HUGE_PAGE_SIZE;
+#else
+    return DEFAULT_HUGE_PAGE_SIZE;
+#endif
+}
+
+PageAllocation allocatePages(size_t size, bool preferHugePages) {
+    PageAllocation allocation;
+
+#ifdef _WIN32
+    if (preferHugePages && GetLargePageMinimum() != 0) {
+        // Requires SeLockMemoryPrivilege, fall back silently when it is missing
+        size_t hugeSize = roundUp(size, GetLargePageMinimum());
+        void* memory = VirtualAlloc(nullptr, hugeSize,
+            MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (memory) {
+            allocation.memory = memory;
+            allocation.size = hugeSize;
+            allocation.hugePages = true;
+            return allocation;
+        }
+    }
+
+    void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (memory) {
+        allocation.memory = memory;
+        allocation.size = size;
+    }
+#else
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+#ifdef MAP_HUGETLB
+    if (preferHugePages) {
+        // Explicit huge pages need a reserved hugetlbfs pool
+        size_t hugeSize = roundUp(size, hugePageSize());
+        void* memory = mmap(nullptr, hugeSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            allocation.memory = memory;
+            allocation.size = hugeSize;
+            allocation.hugePages = true;
+            return allocation;
+        }
+    }
+#endif
+
+    size_t mappedSize = roundUp(size, pageSize);
+    void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory != MAP_FAILED) {
+        allocation.memory = memory;
+        allocation.size = mappedSize;
+#ifdef MADV_HUGEPAGE
+        if (preferHugePages) {
+            // Ask for transparent huge pages instead
+            madvise(memory, mappedSize, MADV_HUGEPAGE);
+        }
+#endif
+    }
+#endif
+
+    return allocation;
+}
+
+void freePages(const PageAllocation& allocation) {
+    if (!allocation.memory) return;
+
+#ifdef _WIN32
+    VirtualFree(allocation.memory, 0, MEM_RELEASE);
+#else
+    munmap(allocation.memory, allocation.size);
+#endif
+}
+
+} // namespace voxceleron
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace voxceleron {
+
+// Page-level allocation backing slab blocks. Huge pages are best effort: if
+// the OS refuses them the block falls back to regular pages.
+struct PageAllocation {
+    void* memory = nullptr;
+    size_t size = 0;
+    bool hugePages = false;
+};
+
+PageAllocation allocatePages(size_t size, bool preferHugePages);
+void freePages(const PageAllocation& allocation);
+size_t hugePageSize();
+
+// Fixed-size slot allocator addressed by 32-bit index.
+//
+// Free slots form an intrusive singly linked list threaded through the slot
+// storage, so allocate and deallocate are O(1). Blocks are registered in a
+// fixed-capacity directory and never move, which keeps both indices and
+// references stable for the lifetime of a slot. The free list is guarded by
+// a mutex. Only the world's editing thread allocates, so the lock is never
+// contended and costs a few nanoseconds per call.
+template<typename T, uint32_t BlockShift = 12, uint32_t MaxBlocks = 4096>
+class SlabAllocator {
+public:
+    static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+    SlabAllocator()
+        : blocks(new Block[MaxBlocks])
+        , blockShift(BlockShift)
+        , preferHugePages(false)
+        , blockCount(0)
+        , nextUnused(0)
+        , freeHead(INVALID_SLOT)
+        , liveCount(0)
+        , reservedBytes(0) {}
+
+    ~SlabAllocator() { clear(); }
+
+    // Construct a T in a free slot and return its index
+    template<typename... Args>
+    uint32_t allocate(Args&&... args) {
+        uint32_t index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            index = acquireSlot();
+        }
+        construct(index, std::forward<Args>(args)...);
+        return index;
+    }
+
+    // Destroy the T at index and return its slot to the free list
+    void deallocate(uint32_t index) {
+        destroy(index);
+        std::lock_guard<std::mutex> lock(mutex);
+        nextFree(index) = freeHead;
+        freeHead = index;
+    }
+
+    T& operator[](uint32_t index) { return *reinterpret_cast<T*>(slot(index)); }
+    const T& operator[](uint32_t index) const { return *reinterpret_cast<const T*>(slot(index)); }
+
+    // Destroy all live objects and release every block
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t count = blockCount.load(std::memory_order_relaxed);
+        for (uint32_t b = 0; b < count; ++b) {
+            Block& block = blocks[b];
+            for (uint32_t i = 0; i < slotsPerBlock(); ++i) {
+                if (block.isLive(i)) {
+                    reinterpret_cast<T*>(block.data + i * SLOT_SIZE)->~T();
+                }
+            }
+            freePages(block.pages);
+            block = Block();
+        }
+        blockCount.store(0, std::memory_order_relaxed);
+        nextUnused = 0;
+        freeHead = INVALID_SLOT;
+        liveCount.store(0, std::memory_order_relaxed);
+        reservedBytes.store(0, std::memory_order_relaxed);
+    }
+
+    // Request huge-page backed blocks. Only possible before the first block
+    // exists; blocks are then grown to at least one huge page each.
+    bool setHugePages(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (blockCount.load(std::memory_order_relaxed) != 0) return false;
+        preferHugePages = enabled;
+        blockShift = BlockShift;
+        if (enabled) {
+            while ((size_t(SLOT_SIZE) << blockShift) < hugePageSize()) {
+                ++blockShift;
+            }
+        }
+        return true;
+    }
+
+    // Visit every live object as fn(index, object). Not safe against
+    // concurrent allocation from other threads.
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        uint32_t count = getBlockCount();
+        for (uint32_t b = 0; b < count; ++b) {
+            const Block& block = blocks[b];
+            for (uint32_t i = 0; i < slotsPerBlock(); ++i) {
+                if (block.isLive(i)) {
+                    fn((b << blockShift) | i, *reinterpret_cast<const T*>(block.data + i * SLOT_SIZE));
+                }
+            }
+        }
+    }
+
+    size_t size() const { return liveCount.load(std::memory_order_relaxed); }
+    uint32_t getBlockCount() const { return blockCount.load(std::memory_order_acquire); }
+
+    size_t memoryUsage() const {
+        return MaxBlocks * sizeof(Block) + reservedBytes.load(std::memory_order_relaxed);
+    }
+
+    bool usingHugePages() const {
+        return getBlockCount() != 0 && blocks[0].pages.hugePages;
+    }
+
+private:
+    static constexpr size_t SLOT_ALIGN = std::max(alignof(T), alignof(uint32_t));
+    static constexpr size_t SLOT_SIZE =
+        (std::max(sizeof(T), sizeof(uint32_t)) + SLOT_ALIGN - 1) & ~(SLOT_ALIGN - 1);
+
+    struct Block {
+        unsigned char* data = nullptr;
+        std::unique_ptr<std::atomic<uint64_t>[]> live;  // One bit per constructed slot
+        PageAllocation pages;
+
+        bool isLive(uint32_t i) const {
+            return (live[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+        }
+    };
+
+    std::unique_ptr<Block[]> blocks;
+    uint32_t blockShift;
+    bool preferHugePages;
+    std::atomic<uint32_t> blockCount;
+    uint32_t nextUnused;      // First never-used slot, blocks are carved lazily
+    uint32_t freeHead;        // Head of the free list
+    std::atomic<size_t> liveCount;
+    std::atomic<size_t> reservedBytes;  // Pages and live bitmaps of all blocks
+    std::mutex mutex;
+
+    uint32_t slotsPerBlock() const { return 1u << blockShift; }
+    size_t bitmapWords() const { return (slotsPerBlock() + 63) / 64; }
+
+    unsigned char* slot(uint32_t index) const {
+        return blocks[index >> blockShift].data + (index & (slotsPerBlock() - 1)) * SLOT_SIZE;
+    }
+
+    uint32_t& nextFree(uint32_t index) { return *reinterpret_cast<uint32_t*>(slot(index)); }
+
+    template<typename... Args>
+    void construct(uint32_t index, Args&&... args) {
+        new (slot(index)) T(std::forward<Args>(args)...);
+        uint32_t local = index & (slotsPerBlock() - 1);
+        blocks[index >> blockShift].live[local >> 6].fetch_or(uint64_t(1) << (local & 63), std::memory_order_relaxed);
+        liveCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void destroy(uint32_t index) {
+        reinterpret_cast<T*>(slot(index))->~T();
+        uint32_t local = index & (slotsPerBlock() - 1);
+        blocks[index >> blockShift].live[local >> 6].fetch_and(~(uint64_t(1) << (local & 63)), std::memory_order_relaxed);
+        liveCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Pop a slot from the free list or carve a new one. Caller holds the mutex.
+    uint32_t acquireSlot() {
+        if (freeHead != INVALID_SLOT) {
+            uint32_t index = freeHead;
+            freeHead = nextFree(index);
+            return index;
+        }
+
+        if ((nextUnused >> blockShift) >= blockCount.load(std::memory_order_relaxed)) {
+            addBlock();
+        }
+        return nextUnused++;
+    }
+
+    void addBlock() {
+        uint32_t count = blockCount.load(std::memory_order_relaxed);
+        if (count >= MaxBlocks) {
+            throw std::bad_alloc();
+        }
+
+        Block& block = blocks[count];
+        block.pages = allocatePages(size_t(SLOT_SIZE) << blockShift, preferHugePages);
+        if (!block.pages.memory) {
+            throw std::bad_alloc();
+        }
+        block.data = static_cast<unsigned char*>(block.pages.memory);
+        block.live.reset(new std::atomic<uint64_t>[bitmapWords()]);
+        for (size_t i = 0; i < bitmapWords(); ++i) {
+            block.live[i].store(0, std::memory_order_relaxed);
+        }
+        reservedBytes.fetch_add(block.pages.size + bitmapWords() * sizeof(uint64_t), std::memory_order_relaxed);
+
+        // Publish the block after its directory entry is complete
+        blockCount.store(count + 1, std::memory_order_release);
+    }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+};
+
+} // namespace voxceleron
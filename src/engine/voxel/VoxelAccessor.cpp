@@ -0,0 +1,126 @@
+#include "VoxelAccessor.h"
+#include <algorithm>
+
+namespace voxceleron {
+
+VoxelAccessor::VoxelAccessor(World& world)
+    : world(world)
+    , version(0)
+    , accessFrame(0)
+    , uniqueDepth(0) {
+}
+
+int VoxelAccessor::resume(const glm::ivec3& pos) {
+    int level = version == world.topologyVersion ? path.sharedLevel(pos) : -1;
+    if (level < 0) {
+        uniqueDepth = 0;
+        return -1;
+    }
+
+    // Regions are stamped once per frame, that is all eviction looks at
+    if (accessFrame != world.accessFrame) {
+        world.regions.touch(World::regionCoord(pos), world.accessFrame);
+        accessFrame = world.accessFrame;
+    }
+    return level;
+}
+
+Voxel VoxelAccessor::get(const glm::ivec3& pos) {
+    int level = resume(pos);
+    if (level < 0) {
+        uint32_t rootIndex = world.accessRegion(World::regionCoord(pos), false);
+        // Restoring a compressed region advances the version
+        version = world.topologyVersion;
+        accessFrame = world.accessFrame;
+        if (rootIndex == INVALID_INDEX) {
+            path.depth = 0;
+            return Voxel{MATERIAL_AIR};
+        }
+        path.nodes[0] = rootIndex;
+        level = 0;
+    }
+
+    // Entries below the resume level may now lead into shared groups
+    uniqueDepth = std::min(uniqueDepth, static_cast<uint32_t>(level) + 1);
+    uint32_t nodeIndex = path.descend(world.nodes, pos, level);
+    if (nodeIndex == INVALID_INDEX) {
+        return Voxel{MATERIAL_AIR};
+    }
+
+    const OctreeNode& node = world.nodes[nodeIndex];
+    if (node.isUniform()) {
+        return unpackVoxel(node.payload);
+    }
+    glm::ivec3 localPos = pos & glm::ivec3(BRICK_SIZE - 1);
+    return unpackVoxel(world.leafPayloads[node.payload].get(VoxelBrick::index(localPos)));
+}
+
+void VoxelAccessor::set(const glm::ivec3& pos, const Voxel& voxel) {
+    int level = std::min(resume(pos), static_cast<int>(uniqueDepth) - 1);
+
+    uint32_t nodeIndex;
+    if (level == static_cast<int>(BRICK_LEVEL)) {
+        // Same brick as the last edit, its path is still unique
+        nodeIndex = path.nodes[BRICK_LEVEL];
+        path.position = pos;
+    } else {
+        // findNode copies whatever is shared below the resume level
+        nodeIndex = world.findNode(pos, true, path.nodes.data(), std::max(level, 0));
+        version = world.topologyVersion;
+        accessFrame = world.accessFrame;
+        if (nodeIndex == INVALID_INDEX) {
+            path.depth = 0;
+            return;
+        }
+        path.position = pos;
+        path.depth = BRICK_LEVEL + 1;
+        uniqueDepth = BRICK_LEVEL + 1;
+    }
+
+    world.writeVoxel(nodeIndex, path.nodes.data(), pos, packVoxel(voxel));
+}
+
+void VoxelAccessor::get(const glm::ivec3* positions, Voxel* voxels, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        voxels[i] = get(positions[i]);
+    }
+}
+
+void VoxelAccessor::set(const VoxelEdit* edits, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        set(edits[i].position, edits[i].voxel);
+    }
+}
+
+Voxel SnapshotAccessor::get(const glm::ivec3& pos) {
+    int level = path.sharedLevel(pos);
+    if (level < 0) {
+        uint32_t rootIndex = snapshot.regions.find(World::regionCoord(pos));
+        if (rootIndex == INVALID_INDEX) {
+            path.depth = 0;
+            return Voxel{MATERIAL_AIR};
+        }
+        path.nodes[0] = rootIndex;
+        level = 0;
+    }
+
+    uint32_t nodeIndex = path.descend(*snapshot.nodes, pos, level);
+    if (nodeIndex == INVALID_INDEX) {
+        return Voxel{MATERIAL_AIR};
+    }
+
+    const OctreeNode& node = (*snapshot.nodes)[nodeIndex];
+    if (node.isUniform()) {
+        return unpackVoxel(node.payload);
+    }
+    glm::ivec3 localPos = pos & glm::ivec3(BRICK_SIZE - 1);
+    return unpackVoxel((*snapshot.payloads)[node.payload].get(VoxelBrick::index(localPos)));
+}
+
+void SnapshotAccessor::get(const glm::ivec3* positions, Voxel* voxels, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        voxels[i] = get(positions[i]);
+    }
+}
+
+} // namespace voxceleron
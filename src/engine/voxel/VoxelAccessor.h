@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+#include "World.h"
+#include "WorldSnapshot.h"
+
+namespace voxceleron {
+
+// Root-to-leaf path of the last lookup, one node per level. Nodes are
+// aligned to their size, so a position inside the same node at some level
+// shares the path down to it and the next descent resumes there.
+struct LeafPath {
+    std::array<uint32_t, MAX_LEVEL + 1> nodes;
+    uint32_t depth = 0;         // Valid entries, the last is a leaf or a node missing the next child
+    glm::ivec3 position{0};     // Position the path was descended for
+
+    // Deepest level whose node on the path also contains pos, -1 if none
+    int sharedLevel(const glm::ivec3& pos) const {
+        uint32_t bits = static_cast<uint32_t>((pos.x ^ position.x) | (pos.y ^ position.y) | (pos.z ^ position.z));
+        if (depth == 0 || (bits >> REGION_SIZE_LOG2) != 0) return -1;
+
+        // The node at level L spans the coordinate bits below MAX_LEVEL - L
+        int level = MAX_LEVEL;
+        while (bits != 0) {
+            bits >>= 1;
+            --level;
+        }
+        return level < static_cast<int>(depth) ? level : static_cast<int>(depth) - 1;
+    }
+
+    // Continue from the node at level, INVALID_INDEX if a child is missing
+    uint32_t descend(const NodePool& pool, const glm::ivec3& pos, uint32_t level) {
+        position = pos;
+        uint32_t current = nodes[level];
+        while (!pool[current].isLeaf()) {
+            const OctreeNode& node = pool[current];
+            uint32_t size = REGION_SIZE >> (level + 1);
+            uint32_t octant = ((pos.x & size) ? 1u : 0u) | ((pos.y & size) ? 2u : 0u) | ((pos.z & size) ? 4u : 0u);
+            if (!node.hasChild(octant)) {
+                depth = level + 1;
+                return INVALID_INDEX;
+            }
+            current = node.child(octant);
+            nodes[++level] = current;
+        }
+        depth = level + 1;
+        return current;
+    }
+};
+
+// Voxel access through a cached leaf path, for loops that walk neighboring
+// voxels (tools, lighting, mesh input). Lookups in the same brick skip the
+// descent entirely and lookups in a sibling descend from the shared parent
+// instead of the root, so coherent access costs a few node reads per voxel.
+//
+// The cache checks the world's topology version before each use, edits
+// made through the world directly are safe. An accessor is not thread-safe
+// and belongs to the editing thread; readers elsewhere use SnapshotAccessor.
+class VoxelAccessor {
+public:
+    explicit VoxelAccessor(World& world);
+
+    Voxel get(const glm::ivec3& pos);
+    void set(const glm::ivec3& pos, const Voxel& voxel);
+
+    // Batches run in the given order, so coherent input keeps hitting the cache
+    void get(const glm::ivec3* positions, Voxel* voxels, size_t count);
+    void set(const VoxelEdit* edits, size_t count);
+
+    void reset() { path.depth = 0; }
+
+private:
+    World& world;
+    LeafPath path;
+    uint64_t version;       // World::topologyVersion the path was built against
+    uint32_t accessFrame;   // Frame the path's region was last touched in
+    uint32_t uniqueDepth;   // Leading path entries known not to be shared, safe to write through
+
+    int resume(const glm::ivec3& pos);
+};
+
+// Read-only accessor for a snapshot, usable on any thread that holds one.
+// Snapshots never change, so the cached path stays valid for its lifetime.
+class SnapshotAccessor {
+public:
+    explicit SnapshotAccessor(const WorldSnapshot& snapshot) : snapshot(snapshot) {}
+
+    Voxel get(const glm::ivec3& pos);
+    void get(const glm::ivec3* positions, Voxel* voxels, size_t count);
+
+private:
+    const WorldSnapshot& snapshot;
+    LeafPath path;
+};
+
+} // namespace voxceleron
@@ -5,144 +5,124 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
+#include "SlabAllocator.h"
 
 namespace voxceleron {
 
 // Forward declarations
 struct OctreeNode;
 
+// Voxels reference their properties through the world's MaterialRegistry
+using MaterialId = uint16_t;
+static constexpr MaterialId MATERIAL_AIR = 0;
+static constexpr MaterialId MATERIAL_MAX = 0xFFFF;
+
 // Basic voxel type
 struct Voxel {
-    uint32_t type;     // Type of the voxel (air, solid, etc.)
-    uint32_t color;    // RGBA color packed into 32 bits
+    MaterialId material;
 };
 
-// Run-length encoding for voxel compression
-struct VoxelRun {
+// Packed voxels, as stored in bricks and uniform leaves, are the material id
+inline uint32_t packVoxel(const Voxel& voxel) {
+    return voxel.material;
+}
+
+inline Voxel unpackVoxel(uint32_t packedVoxel) {
+    return Voxel{static_cast<MaterialId>(packedVoxel)};
+}
+
+// Air is the only empty material
+inline bool isSolidVoxel(uint32_t packedVoxel) {
+    return packedVoxel != MATERIAL_AIR;
+}
+
+// Single voxel write for batched edits
+struct VoxelEdit {
+    glm::ivec3 position;
     Voxel voxel;
-    uint32_t count;    // Number of consecutive identical voxels
 };
 
-// Node data for leaf nodes (contains compressed voxels)
-struct LeafData {
-    std::vector<VoxelRun> runs;  // Run-length encoded voxels
-    std::vector<uint32_t> data;  // Uncompressed voxel data for mesh generation
-    size_t totalVoxels;          // Total number of voxels represented
-    
-    LeafData() : totalVoxels(0) {}
-    ~LeafData() = default;
-    
-    // Helper functions for RLE compression
-    void addVoxel(const Voxel& voxel) {
-        if (runs.empty() || runs.back().voxel.type != voxel.type || 
-            runs.back().voxel.color != voxel.color) {
-            runs.push_back({voxel, 1});
-        } else {
-            runs.back().count++;
-        }
-        totalVoxels++;
-        
-        // Update uncompressed data
-        uint32_t packedVoxel = (voxel.color & 0xFFFFFF00) | (voxel.type & 0xFF);
-        data.push_back(packedVoxel);
-    }
-    
-    Voxel getVoxel(size_t index) const {
-        if (index < data.size()) {
-            uint32_t packedVoxel = data[index];
-            return Voxel{
-                packedVoxel & 0xFF,           // type
-                packedVoxel & 0xFFFFFF00      // color
-            };
-        }
-        return Voxel{0, 0}; // Default voxel if index out of range
-    }
-    
-    void decompressData() {
-        if (data.empty() && !runs.empty()) {
-            data.reserve(totalVoxels);
-            for (const auto& run : runs) {
-                uint32_t packedVoxel = (run.voxel.color & 0xFFFFFF00) | (run.voxel.type & 0xFF);
-                for (uint32_t i = 0; i < run.count; ++i) {
-                    data.push_back(packedVoxel);
-                }
-            }
-        }
+// Interleave the low 16 bits of v so they occupy every third bit
+constexpr uint64_t spreadBits3(uint32_t v) {
+    uint64_t x = v & 0xFFFF;
+    x = (x | (x << 16)) & 0x0000FF0000FFull;
+    x = (x | (x << 8)) & 0x00F00F00F00Full;
+    x = (x | (x << 4)) & 0x0C30C30C30C3ull;
+    x = (x | (x << 2)) & 0x249249249249ull;
+    return x;
+}
+
+// Inverse of spreadBits3, gathers every third bit starting at bit 0
+constexpr uint32_t compactBits3(uint64_t x) {
+    x &= 0x249249249249ull;
+    x = (x | (x >> 2)) & 0x0C30C30C30C3ull;
+    x = (x | (x >> 4)) & 0x00F00F00F00Full;
+    x = (x | (x >> 8)) & 0x0000FF0000FFull;
+    x = (x | (x >> 16)) & 0xFFFF;
+    return static_cast<uint32_t>(x);
+}
+
+// Morton (Z-order) code of a position with 16 bits per axis, x in the lowest bit
+constexpr uint64_t mortonEncode(uint32_t x, uint32_t y, uint32_t z) {
+    return spreadBits3(x) | (spreadBits3(y) << 1) | (spreadBits3(z) << 2);
+}
+
+// Index math for a cubic brick of 2^SizeLog2 voxels per axis. Everything is
+// constexpr, so with the edge length fixed at compile time it folds into
+// shifts and masks.
+template<uint32_t SizeLog2>
+struct BrickLayout {
+    static_assert(SizeLog2 >= 3 && SizeLog2 <= 6, "Bricks span 8 to 64 voxels per axis");
+
+    static constexpr uint32_t SIZE_LOG2 = SizeLog2;
+    static constexpr uint32_t SIZE = 1u << SizeLog2;
+    static constexpr uint32_t VOLUME = SIZE * SIZE * SIZE;
+
+    // x-fastest order, the layout of stored and uploaded bricks
+    static constexpr uint32_t index(uint32_t x, uint32_t y, uint32_t z) {
+        return x | (y << SizeLog2) | (z << (2 * SizeLog2));
     }
-    
-    void compressData() {
-        if (runs.empty() && !data.empty()) {
-            runs.clear();
-            totalVoxels = 0;
-            for (uint32_t packedVoxel : data) {
-                Voxel voxel{
-                    packedVoxel & 0xFF,           // type
-                    packedVoxel & 0xFFFFFF00      // color
-                };
-                addVoxel(voxel);
-            }
-        }
+    static uint32_t index(const glm::ivec3& localPos) {
+        return index(static_cast<uint32_t>(localPos.x), static_cast<uint32_t>(localPos.y),
+                     static_cast<uint32_t>(localPos.z));
     }
-};
+    static constexpr uint32_t indexX(uint32_t index) { return index & (SIZE - 1); }
+    static constexpr uint32_t indexY(uint32_t index) { return (index >> SizeLog2) & (SIZE - 1); }
+    static constexpr uint32_t indexZ(uint32_t index) { return index >> (2 * SizeLog2); }
 
-// Memory pool for efficient node allocation
-template<typename T, size_t BlockSize = 4096>
-class MemoryPool {
-    struct Block {
-        std::array<T, BlockSize> data;
-        std::vector<bool> used;
-        Block() : used(BlockSize, false) {}
-    };
-    
-    std::vector<std::unique_ptr<Block>> blocks;
-    
-public:
-    T* allocate() {
-        for (auto& block : blocks) {
-            for (size_t i = 0; i < BlockSize; ++i) {
-                if (!block->used[i]) {
-                    block->used[i] = true;
-                    return &block->data[i];
-                }
-            }
-        }
-        
-        // No free space found, create new block
-        auto newBlock = std::make_unique<Block>();
-        newBlock->used[0] = true;
-        T* result = &newBlock->data[0];
-        blocks.push_back(std::move(newBlock));
-        return result;
-    }
-    
-    void deallocate(T* ptr) {
-        for (auto& block : blocks) {
-            if (ptr >= &block->data[0] && 
-                ptr < &block->data[0] + BlockSize) {
-                size_t index = ptr - &block->data[0];
-                block->used[index] = false;
-                return;
-            }
-        }
+    // Morton order, every aligned 2^k sub-cube is a contiguous range
+    static constexpr uint32_t mortonIndex(uint32_t x, uint32_t y, uint32_t z) {
+        return static_cast<uint32_t>(mortonEncode(x, y, z));
     }
+    static constexpr uint32_t mortonX(uint32_t morton) { return compactBits3(morton); }
+    static constexpr uint32_t mortonY(uint32_t morton) { return compactBits3(morton >> 1); }
+    static constexpr uint32_t mortonZ(uint32_t morton) { return compactBits3(morton >> 2); }
 };
 
-// Node data for internal nodes (contains children)
-struct InternalData {
-    std::array<std::unique_ptr<OctreeNode>, 8> children;
-    
-    InternalData() = default;
-    ~InternalData() = default;
-};
+// Leaf brick dimensions. The octree stops descending once a node spans
+// BRICK_SIZE voxels and stores the whole brick as one flat array. Builds may
+// pick another edge length with VOXCELERON_BRICK_SIZE_LOG2, from 3 (8^3) to
+// 6 (64^3), e.g. to compare sizes in the benchmarks.
+#ifndef VOXCELERON_BRICK_SIZE_LOG2
+#define VOXCELERON_BRICK_SIZE_LOG2 4    // 16^3 voxels per brick
+#endif
+using Brick = BrickLayout<VOXCELERON_BRICK_SIZE_LOG2>;
+static constexpr uint32_t BRICK_SIZE_LOG2 = Brick::SIZE_LOG2;
+static constexpr uint32_t BRICK_SIZE = Brick::SIZE;
+static constexpr uint32_t BRICK_VOLUME = Brick::VOLUME;
+
+static_assert(Brick::index(1, 2, 3) == 1 + 2 * BRICK_SIZE + 3 * BRICK_SIZE * BRICK_SIZE, "x-fastest layout");
+static_assert(Brick::mortonIndex(1, 1, 1) == 7 && Brick::mortonX(Brick::mortonIndex(5, 6, 7)) == 5,
+              "Morton round trip");
+
+// Dense voxel storage for a leaf, laid out x-fastest to match the compute shader
+template<uint32_t SizeLog2>
+struct alignas(64) BasicVoxelBrick : BrickLayout<SizeLog2> {
+    std::array<MaterialId, BrickLayout<SizeLog2>::VOLUME> voxels{};
 
-// Union to store either leaf or internal node data
-union NodeData {
-    LeafData leaf;
-    InternalData internal;
-    
-    NodeData() {} // Default constructor
-    ~NodeData() {} // Destructor (managed manually due to union)
+    void fill(MaterialId material) { voxels.fill(material); }
 };
+using VoxelBrick = BasicVoxelBrick<BRICK_SIZE_LOG2>;
 
 // Cache entry for mesh data
 struct MeshCacheEntry {
@@ -153,66 +133,103 @@ struct MeshCacheEntry {
     uint64_t lastUsed;      // Timestamp of last use
 };
 
-// Now define OctreeNode after all its dependencies
+// Sentinel for missing node and payload indices
+static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+// Octree node flags. The occupancy bits summarize the subtree so empty or
+// fully solid space can be skipped without decoding any voxels; missing
+// children count as air. They agree with the node's solid count.
+enum NodeFlags : uint8_t {
+    NODE_LEAF      = 1 << 0,    // Node has no children
+    NODE_UNIFORM   = 1 << 1,    // Leaf without a brick, every voxel equals payload
+    NODE_ANY_SOLID = 1 << 2,    // At least one voxel below is solid
+    NODE_ALL_SOLID = 1 << 3     // Every voxel below is solid
+};
+static constexpr uint8_t NODE_OCCUPANCY = NODE_ANY_SOLID | NODE_ALL_SOLID;
+
+// Compact octree node holding only the fields touched during traversal.
+// Children live as 8 contiguous nodes in the NodePool starting at childBase,
+// position and size are implied by the path from the root, and mesh/GPU
+// state, including which nodes need remeshing, is kept in side tables keyed
+// by node index. Nodes shared with snapshots are never written.
+//
+// Every node also summarizes the voxels below it, kept current bottom-up
+// like the occupancy flags: the smallest and largest material, and for
+// internal nodes the solid voxel count in payload. Leaves derive their count
+// from their value or brick. Region queries stop at nodes a box contains.
 struct OctreeNode {
+    uint32_t childBase;     // Pool index of the first child (internal nodes)
+    uint32_t payload;       // Leaf payload index, packed voxel for uniform leaves, solid count for internal nodes
     uint8_t childMask;      // Bitmask indicating which children exist
-    bool isLeaf;           // Whether this is a leaf node
-    uint32_t level;        // LOD level (0 = highest detail)
-    
-    // Node properties
-    glm::ivec3 position;
-    uint32_t size;
-    bool needsUpdate;
-    bool isOptimized;
-    uint32_t optimizedValue;
-    
-    // Node data (either children or voxels)
-    NodeData nodeData;
-    
-    // Mesh data
-    std::shared_ptr<MeshCacheEntry> meshCache;
-    VkBuffer meshBuffer;
-    VkDeviceMemory meshMemory;
-    uint32_t vertexCount;
-    uint32_t indexCount;
-    
-    OctreeNode() : 
-        childMask(0), 
-        isLeaf(false), 
-        level(0),
-        position(0),
-        size(0),
-        needsUpdate(true),
-        isOptimized(false),
-        optimizedValue(0),
-        meshBuffer(VK_NULL_HANDLE),
-        meshMemory(VK_NULL_HANDLE),
-        vertexCount(0),
-        indexCount(0) {
-        // Initialize nodeData based on isLeaf
-        if (isLeaf) {
-            new (&nodeData.leaf) LeafData();
-        } else {
-            new (&nodeData.internal) InternalData();
+    uint8_t flags;          // NodeFlags
+    uint8_t level;          // Depth in the octree (0 = root)
+    uint8_t reserved;
+    MaterialId minMaterial; // Material range below, missing children count as air
+    MaterialId maxMaterial;
+
+    OctreeNode()
+        : childBase(INVALID_INDEX), payload(0), childMask(0), flags(0), level(0), reserved(0)
+        , minMaterial(MATERIAL_AIR), maxMaterial(MATERIAL_AIR) {}
+
+    bool isLeaf() const { return (flags & NODE_LEAF) != 0; }
+    bool isUniform() const { return (flags & NODE_UNIFORM) != 0; }
+    bool anySolid() const { return (flags & NODE_ANY_SOLID) != 0; }
+    bool allSolid() const { return (flags & NODE_ALL_SOLID) != 0; }
+    bool isHomogeneous() const { return minMaterial == maxMaterial; }   // Every voxel below is minMaterial
+    bool hasChild(uint32_t i) const { return (childMask & (1u << i)) != 0; }
+    uint32_t child(uint32_t i) const { return childBase + i; }
+};
+
+static_assert(sizeof(OctreeNode) <= 16, "OctreeNode must stay within 16 bytes");
+
+// Node storage. Siblings are allocated as groups of 8 so a parent only
+// needs the index of its first child; node index = group index * 8 + octant.
+// Groups come from a slab allocator, so node references stay valid while
+// other groups are allocated or freed. Groups are reference counted so
+// identical subtrees can be shared between parents.
+class NodePool {
+public:
+    uint32_t allocateGroup() {
+        uint32_t group = groups.allocate();
+        if (group >= refCounts.size()) {
+            refCounts.resize(group + 1);
         }
+        refCounts[group] = 1;
+        return group << 3;
     }
-    
-    ~OctreeNode() {
-        // Cleanup nodeData based on isLeaf
-        if (isLeaf) {
-            nodeData.leaf.~LeafData();
-        } else {
-            nodeData.internal.~InternalData();
+
+    void addRef(uint32_t base) { ++refCounts[base >> 3]; }
+    uint32_t refCount(uint32_t base) const { return refCounts[base >> 3]; }
+
+    // Drop one reference, freeing the group when it was the last one
+    uint32_t release(uint32_t base) {
+        uint32_t remaining = --refCounts[base >> 3];
+        if (remaining == 0) {
+            groups.deallocate(base >> 3);
         }
+        return remaining;
+    }
+
+    void clear() {
+        groups.clear();
+        refCounts.clear();
     }
-    
-    // Prevent copying
-    OctreeNode(const OctreeNode&) = delete;
-    OctreeNode& operator=(const OctreeNode&) = delete;
-    
-    // Allow moving
-    OctreeNode(OctreeNode&&) = default;
-    OctreeNode& operator=(OctreeNode&&) = default;
+    bool setHugePages(bool enabled) { return groups.setHugePages(enabled); }
+
+    OctreeNode& operator[](uint32_t index) { return groups[index >> 3].nodes[index & 7]; }
+    const OctreeNode& operator[](uint32_t index) const { return groups[index >> 3].nodes[index & 7]; }
+
+    size_t groupCount() const { return groups.size(); }
+    size_t memoryUsage() const {
+        return groups.memoryUsage() + refCounts.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    struct NodeGroup {
+        OctreeNode nodes[8];
+    };
+    SlabAllocator<NodeGroup> groups;
+    std::vector<uint32_t> refCounts;    // Parents referencing each group
 };
 
 } // namespace voxceleron
\ No newline at end of file
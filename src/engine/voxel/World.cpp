@@ -1,25 +1,222 @@
 #include "World.h"
 #include "WorldRenderer.h"
+#include "WorldSnapshot.h"
 #include "../core/Camera.h"
 #include "../vulkan/core/VulkanContext.h"
+#include "LzCodec.h"
+#include "MeshJobPool.h"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <cmath>
 #include <fstream>
-#include <functional>
+#include <cstring>
+#include <thread>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace voxceleron {
 
+namespace {
+
+// FNV-1a, used to hash subtree and brick contents for deduplication
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+uint64_t hashCombine(uint64_t hash, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Morton code of a position within its region. Sorting by it groups edits
+// by octant at every level of the region octree.
+uint64_t mortonKey(const glm::ivec3& pos) {
+    return mortonEncode(static_cast<uint32_t>(pos.x), static_cast<uint32_t>(pos.y), static_cast<uint32_t>(pos.z));
+}
+
+enum class Coverage {
+    Outside,
+    Partial,
+    Inside
+};
+
+struct BoxShape {
+    glm::ivec3 min;
+    glm::ivec3 max;
+
+    // Inclusive bounds of the covered voxels
+    glm::ivec3 first() const { return min; }
+    glm::ivec3 last() const { return max - glm::ivec3(1); }
+
+    Coverage classify(const glm::ivec3& origin, uint32_t size) const {
+        glm::ivec3 end = origin + glm::ivec3(static_cast<int>(size));
+        bool inside = true;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (end[axis] <= min[axis] || origin[axis] >= max[axis]) return Coverage::Outside;
+            inside = inside && origin[axis] >= min[axis] && end[axis] <= max[axis];
+        }
+        return inside ? Coverage::Inside : Coverage::Partial;
+    }
+
+    bool contains(const glm::ivec3& pos) const {
+        return pos.x >= min.x && pos.y >= min.y && pos.z >= min.z &&
+               pos.x < max.x && pos.y < max.y && pos.z < max.z;
+    }
+};
+
+// Covers every voxel whose center lies within the radius
+struct SphereShape {
+    glm::vec3 origin;
+    float radius;
+
+    glm::ivec3 first() const { return glm::ivec3(glm::floor(origin - glm::vec3(radius))); }
+    glm::ivec3 last() const { return glm::ivec3(glm::floor(origin + glm::vec3(radius))); }
+
+    Coverage classify(const glm::ivec3& nodeOrigin, uint32_t size) const {
+        // Bounds of the voxel centers inside the node
+        glm::vec3 lo = glm::vec3(nodeOrigin) + glm::vec3(0.5f);
+        glm::vec3 hi = glm::vec3(nodeOrigin) + glm::vec3(size - 0.5f);
+        float nearest = 0.0f;
+        float farthest = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            float c = origin[axis];
+            float dNear = c < lo[axis] ? lo[axis] - c : (c > hi[axis] ? c - hi[axis] : 0.0f);
+            float dFar = std::max(std::abs(c - lo[axis]), std::abs(c - hi[axis]));
+            nearest += dNear * dNear;
+            farthest += dFar * dFar;
+        }
+        float r2 = radius * radius;
+        if (nearest > r2) return Coverage::Outside;
+        return farthest <= r2 ? Coverage::Inside : Coverage::Partial;
+    }
+
+    bool contains(const glm::ivec3& pos) const {
+        glm::vec3 d = glm::vec3(pos) + glm::vec3(0.5f) - origin;
+        return d.x * d.x + d.y * d.y + d.z * d.z <= radius * radius;
+    }
+};
+
+// Nodes are aligned to their size, so masking any position inside one gives its origin
+glm::ivec3 nodeOrigin(const glm::ivec3& pos, uint32_t size) {
+    return pos & glm::ivec3(~static_cast<int>(size - 1));
+}
+
+// Faces of a node touched by a voxel, bit 2 * axis for the low side and
+// 2 * axis + 1 for the high side
+constexpr uint32_t ALL_FACES = 0x3F;
+
+uint32_t borderFaces(const glm::ivec3& localPos, uint32_t size) {
+    uint32_t faces = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (localPos[axis] == 0) faces |= 1u << (axis * 2);
+        if (localPos[axis] == static_cast<int>(size) - 1) faces |= 1u << (axis * 2 + 1);
+    }
+    return faces;
+}
+
+// Overlap of a node with the box [min, max), false if there is none
+bool clipNode(const glm::ivec3& position, uint32_t size, const glm::ivec3& min, const glm::ivec3& max,
+              glm::ivec3& lo, glm::ivec3& hi) {
+    lo = glm::max(min, position);
+    hi = glm::min(max, position + glm::ivec3(static_cast<int>(size)));
+    return lo.x < hi.x && lo.y < hi.y && lo.z < hi.z;
+}
+
+// Set an extent of a strided dense buffer to one value, row by row so each
+// fill is a contiguous run the compiler can vectorize
+void fillDense(MaterialId* dst, const glm::ivec3& extent, size_t rowStride, size_t sliceStride, MaterialId value) {
+    for (int z = 0; z < extent.z; ++z) {
+        for (int y = 0; y < extent.y; ++y) {
+            std::fill_n(dst + y * rowStride + z * sliceStride, extent.x, value);
+        }
+    }
+}
+
+uint64_t boxVolume(const glm::ivec3& lo, const glm::ivec3& hi) {
+    return uint64_t(hi.x - lo.x) * uint64_t(hi.y - lo.y) * uint64_t(hi.z - lo.z);
+}
+
+// Set bits of a word, without relying on a compiler intrinsic
+uint32_t countBits(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<uint32_t>((x * 0x0101010101010101ull) >> 56);
+}
+
+// Solid voxels of a brick within the local box [lo, hi). Rows never
+// straddle an occupancy word, so each row is a single masked word.
+uint32_t countSolidRows(const PaletteBrick& brick, const glm::ivec3& lo, const glm::ivec3& hi) {
+    const auto& occupancy = brick.getOccupancy();
+    uint32_t length = hi.x - lo.x;
+    uint64_t row = length == 64 ? ~uint64_t(0) : (uint64_t(1) << length) - 1;
+    uint32_t count = 0;
+    for (int z = lo.z; z < hi.z; ++z) {
+        for (int y = lo.y; y < hi.y; ++y) {
+            uint32_t bit = VoxelBrick::index(glm::ivec3(lo.x, y, z));
+            count += countBits(occupancy[bit >> 6] & (row << (bit & 63)));
+        }
+    }
+    return count;
+}
+
+// Step a cell's Morton code one cell along each axis of direction. The
+// axes are added separately in dilated form: with the other axes' bits set
+// the carry ripples straight through them. An axis that wraps around has
+// left the region, its cell is at the same code in the next one.
+void moveCell(NodeLocation& location, const glm::ivec3& direction) {
+    if (location.level == 0) {
+        location.region += direction;
+        return;
+    }
+
+    constexpr uint32_t AXIS_BITS = static_cast<uint32_t>(spreadBits3(REGION_SIZE - 1));
+    uint32_t step = static_cast<uint32_t>(spreadBits3(1u << (MAX_LEVEL - location.level)));
+    for (int axis = 0; axis < 3; ++axis) {
+        if (direction[axis] == 0) continue;
+        uint32_t mask = AXIS_BITS << axis;
+        uint32_t field = location.code & mask;
+        uint32_t moved = direction[axis] > 0 ? ((field | ~mask) + (step << axis)) & mask
+                                             : (field - (step << axis)) & mask;
+        if (direction[axis] > 0 ? moved < field : moved > field) {
+            location.region[axis] += direction[axis];
+        }
+        location.code = (location.code & ~mask) | moved;
+    }
+}
+
+} // namespace
+
 World::World(VulkanContext* context)
-    : context(context)
-    , device(context->getDevice())
-    , physicalDevice(context->getPhysicalDevice())
+    : topologyVersion(0)
+    , brickHeapBytes(0)
+    , deduplicate(false)
+    , compactionPending(false)
+    , compacting(false)
+    , mergedGroups(0)
+    , mergedBricks(0)
+    , memoryBudget(0)
+    , accessFrame(0)
+    , liveSnapshots(0)
+    , context(context)
+    , device(context ? context->getDevice() : VK_NULL_HANDLE)
+    , physicalDevice(context ? context->getPhysicalDevice() : VK_NULL_HANDLE)
     , descriptorPool(VK_NULL_HANDLE)
     , descriptorSetLayout(VK_NULL_HANDLE)
     , pipelineLayout(VK_NULL_HANDLE)
     , computePipeline(VK_NULL_HANDLE)
     , computeQueue(VK_NULL_HANDLE)
-    , commandPool(VK_NULL_HANDLE) {
+    , commandPool(VK_NULL_HANDLE)
+    , meshBackend(MeshBackend::Compute)
+    , meshFormat(MeshFormat::Indexed)
+    , quadBuffer(VK_NULL_HANDLE)
+    , quadMemory(VK_NULL_HANDLE)
+    , quadData(nullptr)
+    , meshThreads(std::max(1u, std::thread::hardware_concurrency()) - 1)
+    , nextMeshTicket(0) {
     std::cout << "World: Creating world instance" << std::endl;
 }
 
@@ -30,13 +227,10 @@ World::~World() {
 
 bool World::initialize() {
     std::cout << "World: Starting initialization..." << std::endl;
-
-    // Create root node
-    root = std::make_unique<OctreeNode>();
-    root->position = glm::ivec3(0);
-    root->size = 1 << MAX_LEVEL;
-    root->level = 0;
-    root->isLeaf = true;
+    if (!context) {
+        std::cerr << "World: Cannot initialize a headless world" << std::endl;
+        return false;
+    }
 
     // Create renderer
     renderer = std::make_unique<WorldRenderer>();
@@ -48,10 +242,11 @@ bool World::initialize() {
     // Create test scene
     createTestScene();
 
-    // Create compute pipeline for mesh generation
+    // Create compute pipeline for mesh generation, meshing falls back to the
+    // CPU without it
     if (!createComputePipeline()) {
-        std::cerr << "World: Failed to create compute pipeline" << std::endl;
-        return false;
+        std::cerr << "World: Failed to create compute pipeline, meshing on the CPU" << std::endl;
+        setMeshBackend(MeshBackend::CpuGreedy);
     }
 
     std::cout << "World: Initialization complete" << std::endl;
@@ -61,6 +256,15 @@ bool World::initialize() {
 void World::cleanup() {
     std::cout << "World: Starting cleanup..." << std::endl;
 
+    // Workers hold snapshots, stop them before releasing those
+    meshJobs.reset();
+    meshJobTickets.clear();
+    meshSnapshot.reset();
+    releaseRetiredSnapshots();
+    if (liveSnapshots > 0) {
+        std::cerr << "World: " << liveSnapshots << " snapshots still alive during cleanup" << std::endl;
+    }
+
     // Clean up renderer
     if (renderer) {
         renderer.reset();
@@ -72,6 +276,15 @@ void World::cleanup() {
     }
     meshes.clear();
 
+    // The device is idle by now, nothing can draw the retired meshes
+    for (auto& retired : retiredMeshes) {
+        for (const MeshData& meshData : retired) {
+            destroyMeshData(meshData);
+        }
+        retired.clear();
+    }
+    cleanupQuadBuffer();
+
     // Clean up Vulkan resources
     if (device != VK_NULL_HANDLE) {
         if (computePipeline != VK_NULL_HANDLE) {
@@ -89,421 +302,1906 @@ void World::cleanup() {
             descriptorSetLayout = VK_NULL_HANDLE;
         }
 
-        if (descriptorPool != VK_NULL_HANDLE) {
-            vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-            descriptorPool = VK_NULL_HANDLE;
+        if (descriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+            descriptorPool = VK_NULL_HANDLE;
+        }
+
+        if (commandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, commandPool, nullptr);
+            commandPool = VK_NULL_HANDLE;
+        }
+    }
+
+    // Clean up octree
+    compactionStack.clear();
+    canonicalGroups.clear();
+    canonicalBricks.clear();
+    compactedGroups.clear();
+    sharedGroups.clear();
+    nodes.clear();
+    leafPayloads.clear();
+    payloadRefs.clear();
+    regions.clear();
+    stats = WorldStats();
+    brickHeapBytes = 0;
+    collapseCandidates.clear();
+    dirtyNodes.clear();
+    compressedRegions.clear();
+    compressedStore.clear();
+    freeCompressedSlots.clear();
+    materials.clear();
+    topologyVersion++;
+
+    std::cout << "World: Cleanup complete" << std::endl;
+}
+
+void World::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
+    std::array<uint32_t, MAX_LEVEL + 1> path;
+    uint32_t nodeIndex = findNode(pos, true, path.data());
+    if (nodeIndex == INVALID_INDEX || !nodes[nodeIndex].isLeaf()) return;
+    writeVoxel(nodeIndex, path.data(), pos, packVoxel(voxel));
+}
+
+void World::writeVoxel(uint32_t nodeIndex, const uint32_t* path, const glm::ivec3& pos, MaterialId material) {
+    PaletteBrick& brick = writableBrick(nodeIndex);
+    size_t brickBytes = brick.memoryUsage();
+    scheduleCompaction();
+
+    // Bricks are aligned to BRICK_SIZE, so the local position is just the low bits
+    glm::ivec3 localPos = pos & glm::ivec3(BRICK_SIZE - 1);
+    uint32_t solidBefore = brick.getSolidCount();
+    brick.set(VoxelBrick::index(localPos), material);
+    brickHeapBytes += brick.memoryUsage() - brickBytes;
+
+    // The path is unique after findNode, ancestors only change if their
+    // child did. Leaves store no count, a changed one always goes up.
+    bool changed = updateSummary(nodeIndex) || brick.getSolidCount() != solidBefore;
+    for (uint32_t level = BRICK_LEVEL; changed && level-- > 0;) {
+        changed = updateSummary(path[level]);
+    }
+
+    // Neighbors only see the border's solidity through their aprons
+    glm::ivec3 brickPos = nodeOrigin(pos, BRICK_SIZE);
+    queueMesh(nodeIndex, brickPos);
+    if (brick.getSolidCount() != solidBefore) {
+        queueNeighborMeshes(brickPos, BRICK_SIZE, borderFaces(localPos, BRICK_SIZE));
+    }
+    markCollapseCandidate(pos, BRICK_LEVEL);
+}
+
+Voxel World::getVoxel(const glm::ivec3& pos) {
+    uint32_t nodeIndex = findLeaf(nodes, accessRegion(regionCoord(pos), false), REGION_SIZE, pos);
+    if (nodeIndex == INVALID_INDEX) {
+        return Voxel{MATERIAL_AIR};  // Return empty voxel if node doesn't exist
+    }
+
+    const OctreeNode& node = nodes[nodeIndex];
+    if (node.isUniform()) {
+        // Collapsed leaf: every voxel shares the payload value
+        return unpackVoxel(node.payload);
+    }
+
+    glm::ivec3 localPos = pos & glm::ivec3(BRICK_SIZE - 1);
+    return unpackVoxel(leafPayloads[node.payload].get(VoxelBrick::index(localPos)));
+}
+
+void World::fillBox(const glm::ivec3& min, const glm::ivec3& max, const Voxel& voxel) {
+    if (max.x <= min.x || max.y <= min.y || max.z <= min.z) return;
+    scheduleCompaction();
+
+    fillShape(BoxShape{min, max}, packVoxel(voxel));
+}
+
+void World::fillSphere(const glm::vec3& center, float radius, const Voxel& voxel) {
+    if (radius <= 0.0f) return;
+    scheduleCompaction();
+
+    fillShape(SphereShape{center, radius}, packVoxel(voxel));
+}
+
+void World::setVoxels(const VoxelEdit* edits, size_t count) {
+    if (count == 0) return;
+    scheduleCompaction();
+
+    // Grouping by region and then Morton order makes the edits for any
+    // subtree one contiguous run, so the descent below touches every node
+    // once. The sort is stable so the last write to a position still wins.
+    std::vector<SortedEdit> sorted;
+    sorted.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const glm::ivec3& pos = edits[i].position;
+        sorted.push_back({regionCoord(pos), mortonKey(pos & glm::ivec3(REGION_SIZE - 1)),
+                          pos, packVoxel(edits[i].voxel)});
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const SortedEdit& a, const SortedEdit& b) {
+            if (a.region.x != b.region.x) return a.region.x < b.region.x;
+            if (a.region.y != b.region.y) return a.region.y < b.region.y;
+            if (a.region.z != b.region.z) return a.region.z < b.region.z;
+            return a.key < b.key;
+        });
+
+    const SortedEdit* run = sorted.data();
+    const SortedEdit* end = run + sorted.size();
+    while (run != end) {
+        const SortedEdit* runEnd = run;
+        bool anySolid = false;
+        while (runEnd != end && runEnd->region == run->region) {
+            anySolid = anySolid || runEnd->packedVoxel != 0;
+            ++runEnd;
+        }
+
+        // Clearing voxels in a region that was never written changes nothing
+        uint32_t root = accessRegion(run->region, anySolid);
+        if (root != INVALID_INDEX) {
+            applyEdits(root, REGION_SIZE, run, runEnd);
+        }
+        run = runEnd;
+    }
+}
+
+void World::copyRegion(const glm::ivec3& srcMin, const glm::ivec3& srcMax, const glm::ivec3& dstMin) {
+    if (srcMax.x <= srcMin.x || srcMax.y <= srcMin.y || srcMax.z <= srcMin.z) return;
+    if (regions.size() == 0 && compressedRegions.size() == 0) return;
+
+    // Read the whole source before writing so overlapping regions copy correctly
+    glm::ivec3 extent = srcMax - srcMin;
+    std::vector<MaterialId> voxels(size_t(extent.x) * extent.y * extent.z);
+    extractRegion(srcMin, srcMax, voxels.data());
+    writeRegion(dstMin, dstMin + extent, voxels.data());
+}
+
+void World::extractRegion(const glm::ivec3& min, const glm::ivec3& max, MaterialId* dst,
+                          size_t rowStride, size_t sliceStride) {
+    if (max.x <= min.x || max.y <= min.y || max.z <= min.z) return;
+    rowStride = rowStride != 0 ? rowStride : max.x - min.x;
+    sliceStride = sliceStride != 0 ? sliceStride : rowStride * (max.y - min.y);
+    auto at = [&](const glm::ivec3& pos) {
+        return dst + (pos.x - min.x) + (pos.y - min.y) * rowStride + (pos.z - min.z) * sliceStride;
+    };
+
+    std::array<MaterialId, BRICK_VOLUME> voxels;
+    glm::ivec3 firstRegion = regionCoord(min);
+    glm::ivec3 lastRegion = regionCoord(max - glm::ivec3(1));
+    for (int rz = firstRegion.z; rz <= lastRegion.z; ++rz) {
+        for (int ry = firstRegion.y; ry <= lastRegion.y; ++ry) {
+            for (int rx = firstRegion.x; rx <= lastRegion.x; ++rx) {
+                glm::ivec3 coord(rx, ry, rz);
+                glm::ivec3 origin = regionOrigin(coord);
+                glm::ivec3 lo, hi;
+                clipNode(origin, REGION_SIZE, min, max, lo, hi);
+
+                uint32_t root = accessRegion(coord, false);
+                if (root == INVALID_INDEX) {
+                    fillDense(at(lo), hi - lo, rowStride, sliceStride, MATERIAL_AIR);
+                    continue;
+                }
+
+                traverseOctree<MAX_LEVEL + 1>(nodes, NodeVisit{root, origin, REGION_SIZE}, [&](const NodeVisit& visit) {
+                    glm::ivec3 lo, hi;
+                    if (!clipNode(visit.position, visit.size, min, max, lo, hi)) return false;
+
+                    const OctreeNode& node = nodes[visit.nodeIndex];
+                    if (node.isUniform()) {
+                        fillDense(at(lo), hi - lo, rowStride, sliceStride, static_cast<MaterialId>(node.payload));
+                        return false;
+                    }
+                    if (node.isLeaf()) {
+                        // Bricks are x-fastest like the buffer, so rows copy straight across
+                        leafPayloads[node.payload].decode(voxels.data());
+                        size_t rowBytes = (hi.x - lo.x) * sizeof(MaterialId);
+                        for (int z = lo.z; z < hi.z; ++z) {
+                            for (int y = lo.y; y < hi.y; ++y) {
+                                glm::ivec3 rowStart(lo.x, y, z);
+                                std::memcpy(at(rowStart), &voxels[VoxelBrick::index(rowStart - visit.position)], rowBytes);
+                            }
+                        }
+                        return false;
+                    }
+
+                    // Missing children are empty
+                    uint32_t childSize = visit.size >> 1;
+                    for (uint32_t i = 0; i < 8; ++i) {
+                        glm::ivec3 childLo, childHi;
+                        if (!node.hasChild(i) &&
+                            clipNode(visit.position + childOffset(i, childSize), childSize, min, max, childLo, childHi)) {
+                            fillDense(at(childLo), childHi - childLo, rowStride, sliceStride, MATERIAL_AIR);
+                        }
+                    }
+                    return true;
+                });
+            }
+        }
+    }
+}
+
+void World::writeRegion(const glm::ivec3& min, const glm::ivec3& max, const MaterialId* src,
+                        size_t rowStride, size_t sliceStride) {
+    if (max.x <= min.x || max.y <= min.y || max.z <= min.z) return;
+    scheduleCompaction();
+
+    DenseSource source;
+    source.min = min;
+    source.max = max;
+    source.data = src;
+    source.rowStride = rowStride != 0 ? rowStride : max.x - min.x;
+    source.sliceStride = sliceStride != 0 ? sliceStride : source.rowStride * (max.y - min.y);
+
+    glm::ivec3 firstRegion = regionCoord(min);
+    glm::ivec3 lastRegion = regionCoord(max - glm::ivec3(1));
+    for (int rz = firstRegion.z; rz <= lastRegion.z; ++rz) {
+        for (int ry = firstRegion.y; ry <= lastRegion.y; ++ry) {
+            for (int rx = firstRegion.x; rx <= lastRegion.x; ++rx) {
+                glm::ivec3 coord(rx, ry, rz);
+                glm::ivec3 origin = regionOrigin(coord);
+                glm::ivec3 lo, hi;
+                clipNode(origin, REGION_SIZE, min, max, lo, hi);
+
+                // Writing only air to a region never written changes nothing
+                MaterialId value;
+                bool allAir = source.isUniform(lo, hi, value) && value == MATERIAL_AIR;
+                uint32_t root = accessRegion(coord, !allAir);
+                if (root == INVALID_INDEX) continue;
+                writeNode(root, origin, REGION_SIZE, source);
+            }
+        }
+    }
+}
+
+bool World::DenseSource::isUniform(const glm::ivec3& lo, const glm::ivec3& hi, MaterialId& value) const {
+    value = *at(lo.x, lo.y, lo.z);
+    for (int z = lo.z; z < hi.z; ++z) {
+        for (int y = lo.y; y < hi.y; ++y) {
+            const MaterialId* row = at(lo.x, y, z);
+            for (int x = 0; x < hi.x - lo.x; ++x) {
+                if (row[x] != value) return false;
+            }
+        }
+    }
+    return true;
+}
+
+void World::writeNode(uint32_t nodeIndex, const glm::ivec3& position, uint32_t size, const DenseSource& src) {
+    glm::ivec3 lo, hi;
+    if (!clipNode(position, size, src.min, src.max, lo, hi)) return;
+
+    // Uniform sources collapse covered nodes and leave matching leaves alone.
+    // The scan stops at the first differing voxel, so mixed content costs little.
+    MaterialId value;
+    const OctreeNode& node = nodes[nodeIndex];
+    bool covered = lo == position && hi == position + glm::ivec3(static_cast<int>(size));
+    if ((covered || node.isUniform()) && src.isUniform(lo, hi, value)) {
+        if (node.isLeaf() && node.isUniform() && node.payload == value) return;
+        if (covered) {
+            setUniform(nodeIndex, position, value);
+            queueNeighborMeshes(position, size, ALL_FACES);
+            markCollapseCandidate(position, nodes[nodeIndex].level);
+            return;
+        }
+    }
+
+    if (node.level == BRICK_LEVEL) {
+        PaletteBrick& brick = writableBrick(nodeIndex);
+        size_t brickBytes = brick.memoryUsage();
+        for (int z = lo.z; z < hi.z; ++z) {
+            for (int y = lo.y; y < hi.y; ++y) {
+                const MaterialId* row = src.at(lo.x, y, z);
+                uint32_t index = VoxelBrick::index(glm::ivec3(lo.x, y, z) - position);
+                for (int x = 0; x < hi.x - lo.x; ++x) {
+                    brick.set(index + x, row[x]);
+                }
+            }
+        }
+        brickHeapBytes += brick.memoryUsage() - brickBytes;
+
+        // Neighbors only see the faces the box reaches
+        uint32_t faces = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (lo[axis] == position[axis]) faces |= 1u << (axis * 2);
+            if (hi[axis] == position[axis] + static_cast<int>(BRICK_SIZE)) faces |= 1u << (axis * 2 + 1);
+        }
+        updateSummary(nodeIndex);
+        queueMesh(nodeIndex, position);
+        queueNeighborMeshes(position, BRICK_SIZE, faces);
+        markCollapseCandidate(position, BRICK_LEVEL);
+        return;
+    }
+
+    if (node.isLeaf()) {
+        subdivideNode(nodeIndex, position);
+    }
+    makeChildrenUnique(nodeIndex, position);
+
+    uint32_t childSize = size >> 1;
+    for (uint32_t i = 0; i < 8; ++i) {
+        glm::ivec3 childPosition = position + childOffset(i, childSize);
+        if (!nodes[nodeIndex].hasChild(i)) {
+            // Missing children are empty already
+            glm::ivec3 childLo, childHi;
+            if (!clipNode(childPosition, childSize, src.min, src.max, childLo, childHi)) continue;
+            if (src.isUniform(childLo, childHi, value) && value == MATERIAL_AIR) continue;
+
+            addChild(nodeIndex, i);
+        }
+        writeNode(nodes[nodeIndex].child(i), childPosition, childSize, src);
+    }
+    updateSummary(nodeIndex);
+}
+
+template<typename Visit>
+void World::visitBox(const glm::ivec3& min, const glm::ivec3& max, Visit&& visit) {
+    if (max.x <= min.x || max.y <= min.y || max.z <= min.z) return;
+
+    bool stopped = false;
+    glm::ivec3 firstRegion = regionCoord(min);
+    glm::ivec3 lastRegion = regionCoord(max - glm::ivec3(1));
+    for (int rz = firstRegion.z; rz <= lastRegion.z && !stopped; ++rz) {
+        for (int ry = firstRegion.y; ry <= lastRegion.y && !stopped; ++ry) {
+            for (int rx = firstRegion.x; rx <= lastRegion.x && !stopped; ++rx) {
+                glm::ivec3 coord(rx, ry, rz);
+                glm::ivec3 origin = regionOrigin(coord);
+                glm::ivec3 lo, hi;
+                clipNode(origin, REGION_SIZE, min, max, lo, hi);
+
+                uint32_t root = accessRegion(coord, false);
+                if (root == INVALID_INDEX) {
+                    stopped = visit(INVALID_INDEX, origin, REGION_SIZE, lo, hi) == BoxStep::Stop;
+                    continue;
+                }
+
+                traverseOctree<MAX_LEVEL + 1>(nodes, NodeVisit{root, origin, REGION_SIZE}, [&](const NodeVisit& node) {
+                    glm::ivec3 lo, hi;
+                    if (stopped || !clipNode(node.position, node.size, min, max, lo, hi)) return false;
+
+                    BoxStep step = visit(node.nodeIndex, node.position, node.size, lo, hi);
+                    if (step != BoxStep::Descend || nodes[node.nodeIndex].isLeaf()) {
+                        stopped = step == BoxStep::Stop;
+                        return false;
+                    }
+
+                    // Missing children are air, the walk only reaches present ones
+                    uint32_t childSize = node.size >> 1;
+                    for (uint32_t i = 0; i < 8 && !stopped; ++i) {
+                        glm::ivec3 childPosition = node.position + childOffset(i, childSize);
+                        glm::ivec3 childLo, childHi;
+                        if (!nodes[node.nodeIndex].hasChild(i) &&
+                            clipNode(childPosition, childSize, min, max, childLo, childHi)) {
+                            stopped = visit(INVALID_INDEX, childPosition, childSize, childLo, childHi) == BoxStep::Stop;
+                        }
+                    }
+                    return !stopped;
+                });
+            }
+        }
+    }
+}
+
+uint64_t World::countSolid(const glm::ivec3& min, const glm::ivec3& max) {
+    uint64_t count = 0;
+    visitBox(min, max, [&](uint32_t nodeIndex, const glm::ivec3& position, uint32_t size,
+                           const glm::ivec3& lo, const glm::ivec3& hi) {
+        if (nodeIndex == INVALID_INDEX) return BoxStep::Skip;
+        const OctreeNode& node = nodes[nodeIndex];
+        bool covered = lo == position && hi == position + glm::ivec3(static_cast<int>(size));
+        if (covered) {
+            count += solidCount(nodeIndex);
+            return BoxStep::Skip;
+        }
+        if (!node.anySolid()) return BoxStep::Skip;
+        if (node.allSolid()) {
+            count += boxVolume(lo, hi);
+            return BoxStep::Skip;
+        }
+        if (!node.isLeaf()) return BoxStep::Descend;
+
+        // Partly solid leaves are always bricks
+        count += countSolidRows(leafPayloads[node.payload], lo - position, hi - position);
+        return BoxStep::Skip;
+    });
+    return count;
+}
+
+bool World::isEmpty(const glm::ivec3& min, const glm::ivec3& max) {
+    bool empty = true;
+    visitBox(min, max, [&](uint32_t nodeIndex, const glm::ivec3& position, uint32_t size,
+                           const glm::ivec3& lo, const glm::ivec3& hi) {
+        if (nodeIndex == INVALID_INDEX || !nodes[nodeIndex].anySolid()) return BoxStep::Skip;
+        const OctreeNode& node = nodes[nodeIndex];
+        bool covered = lo == position && hi == position + glm::ivec3(static_cast<int>(size));
+        if (!covered && !node.allSolid()) {
+            if (!node.isLeaf()) return BoxStep::Descend;
+            if (countSolidRows(leafPayloads[node.payload], lo - position, hi - position) == 0) return BoxStep::Skip;
+        }
+        empty = false;
+        return BoxStep::Stop;
+    });
+    return empty;
+}
+
+std::unordered_map<MaterialId, uint64_t> World::materialHistogram(const glm::ivec3& min, const glm::ivec3& max) {
+    std::unordered_map<MaterialId, uint64_t> histogram;
+    std::array<MaterialId, BRICK_VOLUME> voxels;
+    visitBox(min, max, [&](uint32_t nodeIndex, const glm::ivec3& position, uint32_t size,
+                           const glm::ivec3& lo, const glm::ivec3& hi) {
+        if (nodeIndex == INVALID_INDEX) {
+            histogram[MATERIAL_AIR] += boxVolume(lo, hi);
+            return BoxStep::Skip;
+        }
+        const OctreeNode& node = nodes[nodeIndex];
+        if (node.isHomogeneous()) {
+            histogram[node.minMaterial] += boxVolume(lo, hi);
+            return BoxStep::Skip;
+        }
+        if (!node.isLeaf()) return BoxStep::Descend;
+
+        // The palette counts every material of a whole brick, parts are decoded
+        const PaletteBrick& brick = leafPayloads[node.payload];
+        if (lo == position && hi == position + glm::ivec3(static_cast<int>(size))) {
+            brick.forEachMaterial([&](MaterialId material, uint32_t count) {
+                histogram[material] += count;
+            });
+            return BoxStep::Skip;
+        }
+        brick.decode(voxels.data());
+        for (int z = lo.z; z < hi.z; ++z) {
+            for (int y = lo.y; y < hi.y; ++y) {
+                const MaterialId* row = &voxels[VoxelBrick::index(glm::ivec3(lo.x, y, z) - position)];
+                for (int x = 0; x < hi.x - lo.x; ++x) {
+                    histogram[row[x]]++;
+                }
+            }
+        }
+        return BoxStep::Skip;
+    });
+    return histogram;
+}
+
+template<typename Shape>
+void World::fillShape(const Shape& shape, uint32_t packedVoxel) {
+    glm::ivec3 firstRegion = regionCoord(shape.first());
+    glm::ivec3 lastRegion = regionCoord(shape.last());
+    for (int rz = firstRegion.z; rz <= lastRegion.z; ++rz) {
+        for (int ry = firstRegion.y; ry <= lastRegion.y; ++ry) {
+            for (int rx = firstRegion.x; rx <= lastRegion.x; ++rx) {
+                glm::ivec3 coord(rx, ry, rz);
+                glm::ivec3 origin = regionOrigin(coord);
+                if (shape.classify(origin, REGION_SIZE) == Coverage::Outside) continue;
+
+                // Regions never written are empty already
+                uint32_t root = accessRegion(coord, packedVoxel != 0);
+                if (root == INVALID_INDEX) continue;
+                fillNode(root, origin, REGION_SIZE, shape, packedVoxel);
+            }
+        }
+    }
+}
+
+template<typename Shape>
+void World::fillNode(uint32_t nodeIndex, const glm::ivec3& position, uint32_t size,
+                     const Shape& shape, uint32_t packedVoxel) {
+    Coverage coverage = shape.classify(position, size);
+    if (coverage == Coverage::Outside) return;
+    if (coverage == Coverage::Inside) {
+        if (nodes[nodeIndex].isLeaf() && nodes[nodeIndex].isUniform() && nodes[nodeIndex].payload == packedVoxel) return;
+        setUniform(nodeIndex, position, packedVoxel);
+        queueNeighborMeshes(position, size, ALL_FACES);
+        markCollapseCandidate(position, nodes[nodeIndex].level);
+        return;
+    }
+
+    const OctreeNode& node = nodes[nodeIndex];
+    if (node.isLeaf() && node.isUniform() && node.payload == packedVoxel) return;
+
+    if (node.level == BRICK_LEVEL) {
+        PaletteBrick& brick = writableBrick(nodeIndex);
+        size_t brickBytes = brick.memoryUsage();
+        uint32_t faces = 0;
+        for (uint32_t z = 0; z < BRICK_SIZE; ++z) {
+            for (uint32_t y = 0; y < BRICK_SIZE; ++y) {
+                for (uint32_t x = 0; x < BRICK_SIZE; ++x) {
+                    glm::ivec3 localPos(x, y, z);
+                    if (shape.contains(position + localPos)) {
+                        brick.set(VoxelBrick::index(localPos), packedVoxel);
+                        faces |= borderFaces(localPos, BRICK_SIZE);
+                    }
+                }
+            }
+        }
+        brickHeapBytes += brick.memoryUsage() - brickBytes;
+        updateSummary(nodeIndex);
+        queueMesh(nodeIndex, position);
+        queueNeighborMeshes(position, BRICK_SIZE, faces);
+        markCollapseCandidate(position, BRICK_LEVEL);
+        return;
+    }
+
+    if (node.isLeaf()) {
+        subdivideNode(nodeIndex, position);
+    }
+    makeChildrenUnique(nodeIndex, position);
+
+    uint32_t childSize = size >> 1;
+    for (uint32_t i = 0; i < 8; ++i) {
+        glm::ivec3 childPosition = position + childOffset(i, childSize);
+        if (!nodes[nodeIndex].hasChild(i)) {
+            // Missing children are empty already
+            if (packedVoxel == 0) continue;
+            if (shape.classify(childPosition, childSize) == Coverage::Outside) continue;
+
+            addChild(nodeIndex, i);
+        }
+        fillNode(nodes[nodeIndex].child(i), childPosition, childSize, shape, packedVoxel);
+    }
+    updateSummary(nodeIndex);
+}
+
+void World::applyEdits(uint32_t nodeIndex, uint32_t size, const SortedEdit* begin, const SortedEdit* end) {
+    // Nodes are aligned to their size, so any edit below locates this one
+    glm::ivec3 position = nodeOrigin(begin->position, size);
+    if (nodes[nodeIndex].level == BRICK_LEVEL) {
+        PaletteBrick& brick = writableBrick(nodeIndex);
+        size_t brickBytes = brick.memoryUsage();
+        uint32_t faces = 0;
+        for (const SortedEdit* edit = begin; edit != end; ++edit) {
+            glm::ivec3 localPos = edit->position & glm::ivec3(BRICK_SIZE - 1);
+            brick.set(VoxelBrick::index(localPos), edit->packedVoxel);
+            faces |= borderFaces(localPos, BRICK_SIZE);
+        }
+        brickHeapBytes += brick.memoryUsage() - brickBytes;
+        updateSummary(nodeIndex);
+        queueMesh(nodeIndex, position);
+        queueNeighborMeshes(position, BRICK_SIZE, faces);
+        markCollapseCandidate(begin->position, BRICK_LEVEL);
+        return;
+    }
+
+    if (nodes[nodeIndex].isLeaf()) {
+        subdivideNode(nodeIndex, position);
+    }
+    makeChildrenUnique(nodeIndex, position);
+
+    // Edits are in Morton order, so each child's edits form one run
+    uint32_t childSize = size >> 1;
+    const SortedEdit* run = begin;
+    while (run != end) {
+        uint32_t index = childIndex(run->position, childSize);
+        const SortedEdit* runEnd = run;
+        bool anySolid = false;
+        while (runEnd != end && childIndex(runEnd->position, childSize) == index) {
+            anySolid = anySolid || runEnd->packedVoxel != 0;
+            ++runEnd;
+        }
+
+        if (!nodes[nodeIndex].hasChild(index)) {
+            // Clearing voxels in a missing child changes nothing
+            if (!anySolid) {
+                run = runEnd;
+                continue;
+            }
+            addChild(nodeIndex, index);
+        }
+        applyEdits(nodes[nodeIndex].child(index), childSize, run, runEnd);
+        run = runEnd;
+    }
+    updateSummary(nodeIndex);
+}
+
+void World::updateLOD(const glm::vec3& viewerPos) {
+    if (regions.size() == 0) return;
+
+    // Update LOD levels based on distance from viewer
+    traverse([&](const NodeVisit& visit) {
+        // Shared subtrees are also seen by snapshots or other DAG parents,
+        // reshaping them in place would change those too
+        const OctreeNode& node = nodes[visit.nodeIndex];
+        if (!node.isLeaf() && node.childBase != INVALID_INDEX && nodes.refCount(node.childBase) > 1) {
+            return false;
+        }
+
+        // Calculate distance to viewer
+        glm::vec3 center = glm::vec3(visit.position) + glm::vec3(visit.size / 2);
+        float distance = glm::length(center - viewerPos);
+
+        // Determine desired LOD level based on distance
+        float factor = distance / (visit.size * 2.0f);
+        uint32_t desiredLevel = static_cast<uint32_t>(glm::log2(factor));
+        desiredLevel = glm::clamp(desiredLevel, 0u, MAX_LEVEL);
+
+        // Split or merge based on desired level, children are visited afterwards
+        uint32_t level = nodes[visit.nodeIndex].level;
+        bool isLeaf = nodes[visit.nodeIndex].isLeaf();
+        if (desiredLevel > level && !isLeaf) {
+            // Node is too detailed, try to merge
+            optimizeNode(visit.nodeIndex, visit.position);
+        } else if (desiredLevel < level && isLeaf) {
+            // Node needs more detail, split
+            subdivideNode(visit.nodeIndex, visit.position);
+        }
+        return true;
+    });
+}
+
+void World::generateMeshes(const glm::vec3& viewerPos) {
+    uploadFinishedMeshes();
+    if (dirtyNodes.empty()) return;
+
+    // The viewer moves between frames, so the heap is rebuilt from the
+    // queue rather than kept with stale distances. This only touches
+    // queued leaves, never the whole tree.
+    struct PendingMesh {
+        uint32_t nodeIndex;
+        float distance;
+    };
+    std::vector<PendingMesh> heap;
+    heap.reserve(dirtyNodes.size());
+    for (const auto& [nodeIndex, position] : dirtyNodes) {
+        uint32_t size = REGION_SIZE >> nodes[nodeIndex].level;
+        glm::vec3 center = glm::vec3(position) + glm::vec3(size / 2);
+        heap.push_back({nodeIndex, glm::length(center - viewerPos)});
+    }
+    auto farther = [](const PendingMesh& a, const PendingMesh& b) {
+        return a.distance > b.distance;
+    };
+    std::make_heap(heap.begin(), heap.end(), farther);
+
+    // With workers the budget keeps each a few bricks ahead, closer ones
+    // queued later still go first next frame
+    uint32_t budget = MESH_BUDGET;
+    if (meshJobs) {
+        size_t limit = size_t(MESH_JOBS_PER_THREAD) * meshJobs->getThreadCount();
+        size_t pending = meshJobs->getPendingCount();
+        budget = pending < limit ? static_cast<uint32_t>(limit - pending) : 0;
+    }
+
+    // Closest first; whatever is left over waits for the next frame
+    for (; budget > 0 && !heap.empty(); --budget) {
+        std::pop_heap(heap.begin(), heap.end(), farther);
+        uint32_t nodeIndex = heap.back().nodeIndex;
+        heap.pop_back();
+
+        if (!nodes[nodeIndex].isLeaf()) {
+            // Only leaves carry meshable voxels
+            dirtyNodes.erase(nodeIndex);
+            continue;
+        }
+        if (generateMeshForNode(nodeIndex, REGION_SIZE >> nodes[nodeIndex].level)) {
+            dirtyNodes.erase(nodeIndex);
+        }
+    }
+    meshSnapshot.reset();
+    releaseRetiredSnapshots();
+}
+
+void World::queueMesh(uint32_t nodeIndex, const glm::ivec3& position) {
+    // The queue alone tracks dirtiness, queued nodes may be shared with
+    // snapshots being read on other threads and must not be written
+    dirtyNodes[nodeIndex] = position;
+    meshJobTickets.erase(nodeIndex);
+}
+
+void World::queueNeighborMeshes(const glm::ivec3& position, uint32_t size, uint32_t faces) {
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int side = 0; side < 2; ++side) {
+            if (!(faces & (1u << (axis * 2 + side)))) continue;
+
+            // One voxel thick slab just outside the face. It never crosses a
+            // region boundary, the node itself lies within one region.
+            glm::ivec3 slabMin = position;
+            glm::ivec3 slabMax = position + glm::ivec3(static_cast<int>(size));
+            slabMin[axis] = side ? position[axis] + static_cast<int>(size) : position[axis] - 1;
+            slabMax[axis] = slabMin[axis] + 1;
+
+            glm::ivec3 coord = regionCoord(slabMin);
+            uint32_t root = regions.find(coord);
+            traverseOctree<MAX_LEVEL + 1>(nodes, NodeVisit{root, regionOrigin(coord), REGION_SIZE},
+                [&](const NodeVisit& visit) {
+                    glm::ivec3 end = visit.position + glm::ivec3(static_cast<int>(visit.size));
+                    for (int i = 0; i < 3; ++i) {
+                        if (end[i] <= slabMin[i] || visit.position[i] >= slabMax[i]) return false;
+                    }
+                    // Empty space has no faces to reveal or hide
+                    const OctreeNode& node = nodes[visit.nodeIndex];
+                    if (!node.anySolid()) return false;
+                    if (node.isLeaf()) {
+                        queueMesh(visit.nodeIndex, visit.position);
+                    }
+                    return true;
+                });
+        }
+    }
+}
+
+void World::prepareFrame(const Camera& camera) {
+    if (renderer) {
+        renderer->prepareFrame(camera, *this);
+    }
+}
+
+void World::render(VkCommandBuffer commandBuffer) {
+    if (renderer) {
+        renderer->recordCommands(commandBuffer);
+    }
+}
+
+void World::setDebugVisualization(bool enabled) {
+    if (renderer) {
+        renderer->setDebugVisualization(enabled);
+    }
+}
+
+bool World::isDebugVisualizationEnabled() const {
+    return renderer ? renderer->isDebugVisualizationEnabled() : false;
+}
+
+uint32_t World::childIndex(const glm::ivec3& pos, uint32_t childSize) {
+    // Nodes are aligned to their size, so the child octant is the coordinate bit at childSize
+    return ((pos.x & childSize) ? 1u : 0u) |
+           ((pos.y & childSize) ? 2u : 0u) |
+           ((pos.z & childSize) ? 4u : 0u);
+}
+
+glm::ivec3 World::childOffset(uint32_t childIndex, uint32_t childSize) {
+    return glm::ivec3(
+        (childIndex & 1) ? childSize : 0,
+        (childIndex & 2) ? childSize : 0,
+        (childIndex & 4) ? childSize : 0
+    );
+}
+
+uint32_t World::createRegion(const glm::ivec3& regionCoord) {
+    // The root occupies the first slot of its own group
+    uint32_t rootIndex = nodes.allocateGroup();
+    OctreeNode& root = nodes[rootIndex];
+    root.level = 0;
+    root.flags = (BRICK_LEVEL == 0) ? (NODE_LEAF | NODE_UNIFORM) : 0;
+    countNode(rootIndex, 1);
+    regions.insert(regionCoord, rootIndex);
+    topologyVersion++;
+    return rootIndex;
+}
+
+bool World::releaseRegion(const glm::ivec3& regionCoord) {
+    if (takeCompressedRegion(regionCoord)) return true;
+
+    uint32_t rootIndex = regions.find(regionCoord);
+    if (rootIndex == INVALID_INDEX) return false;
+    dropResidentRegion(regionCoord, rootIndex);
+    return true;
+}
+
+void World::dropResidentRegion(const glm::ivec3& regionCoord, uint32_t rootIndex) {
+    countSubtree(rootIndex, -1);
+    regions.erase(regionCoord);
+    releaseGroup(rootIndex);
+
+    // Bricks across the border culled faces against it, it reads as air now
+    queueNeighborMeshes(regionOrigin(regionCoord), REGION_SIZE, ALL_FACES);
+}
+
+uint32_t World::accessRegion(const glm::ivec3& regionCoord, bool create) {
+    uint32_t rootIndex = regions.touch(regionCoord, accessFrame);
+    if (rootIndex != INVALID_INDEX) return rootIndex;
+
+    // A region that failed to restore is still stored, an empty one must not replace it
+    rootIndex = restoreRegion(regionCoord);
+    if (rootIndex == INVALID_INDEX && create && compressedRegions.find(regionCoord) == INVALID_INDEX) {
+        rootIndex = createRegion(regionCoord);
+    }
+    if (rootIndex != INVALID_INDEX) {
+        regions.touch(regionCoord, accessFrame);
+    }
+    return rootIndex;
+}
+
+bool World::compressRegion(const glm::ivec3& regionCoord) {
+    uint32_t rootIndex = regions.find(regionCoord);
+    if (rootIndex == INVALID_INDEX) return false;
+
+    std::vector<uint8_t> raw;
+    serializeNode(rootIndex, raw);
+    auto region = std::make_shared<CompressedRegion>();
+    region->data.resize(lz::compressBound(raw.size()));
+    region->data.resize(lz::compress(raw.data(), raw.size(), region->data.data()));
+    region->data.shrink_to_fit();
+    region->rawSize = raw.size();
+    dropResidentRegion(regionCoord, rootIndex);
+
+    uint32_t slot;
+    if (!freeCompressedSlots.empty()) {
+        slot = freeCompressedSlots.back();
+        freeCompressedSlots.pop_back();
+        compressedStore[slot] = region;
+    } else {
+        slot = static_cast<uint32_t>(compressedStore.size());
+        compressedStore.push_back(region);
+    }
+    compressedRegions.insert(regionCoord, slot);
+
+    stats.compressedRegions++;
+    stats.compressedBytes += region->data.capacity();
+    stats.uncompressedBytes += region->rawSize;
+    return true;
+}
+
+std::shared_ptr<const CompressedRegion> World::takeCompressedRegion(const glm::ivec3& regionCoord) {
+    uint32_t slot = compressedRegions.find(regionCoord);
+    if (slot == INVALID_INDEX) return nullptr;
+
+    std::shared_ptr<const CompressedRegion> region = std::move(compressedStore[slot]);
+    compressedStore[slot].reset();
+    freeCompressedSlots.push_back(slot);
+    compressedRegions.erase(regionCoord);
+
+    stats.compressedRegions--;
+    stats.compressedBytes -= region->data.capacity();
+    stats.uncompressedBytes -= region->rawSize;
+    return region;
+}
+
+uint32_t World::restoreRegion(const glm::ivec3& regionCoord) {
+    // The stored copy is only dropped once the region is resident again, so
+    // a region that fails to decode keeps its data
+    uint32_t slot = compressedRegions.find(regionCoord);
+    if (slot == INVALID_INDEX) return INVALID_INDEX;
+    std::shared_ptr<const CompressedRegion> region = compressedStore[slot];
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> raw(region->rawSize);
+    if (!lz::decompress(region->data.data(), region->data.size(), raw.data(), raw.size())) {
+        std::cerr << "World: Failed to decompress region (" << regionCoord.x << ", "
+                  << regionCoord.y << ", " << regionCoord.z << ")" << std::endl;
+        return INVALID_INDEX;
+    }
+
+    uint32_t rootIndex = createRegion(regionCoord);
+    if (deserializeNode(rootIndex, regionOrigin(regionCoord), raw.data()) != raw.data() + raw.size()) {
+        std::cerr << "World: Region (" << regionCoord.x << ", " << regionCoord.y << ", "
+                  << regionCoord.z << ") does not match its stored size" << std::endl;
+        dropResidentRegion(regionCoord, rootIndex);
+        return INVALID_INDEX;
+    }
+    takeCompressedRegion(regionCoord);
+    queueNeighborMeshes(regionOrigin(regionCoord), REGION_SIZE, ALL_FACES);
+
+    stats.restoredRegions++;
+    stats.restoreMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return rootIndex;
+}
+
+void World::serializeNode(uint32_t nodeIndex, std::vector<uint8_t>& out) const {
+    // Pre-order: flags, then the uniform value, the brick's voxels or the
+    // child mask followed by each present child
+    const OctreeNode& node = nodes[nodeIndex];
+    out.push_back(node.flags);
+    if (node.isUniform()) {
+        MaterialId material = static_cast<MaterialId>(node.payload);
+        const uint8_t* value = reinterpret_cast<const uint8_t*>(&material);
+        out.insert(out.end(), value, value + sizeof(material));
+        return;
+    }
+    if (node.isLeaf()) {
+        std::array<MaterialId, BRICK_VOLUME> voxels;
+        leafPayloads[node.payload].decode(voxels.data());
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(voxels.data());
+        out.insert(out.end(), bytes, bytes + sizeof(voxels));
+        return;
+    }
+
+    out.push_back(node.childMask);
+    for (uint32_t i = 0; i < 8; ++i) {
+        if (node.hasChild(i)) {
+            serializeNode(node.child(i), out);
+        }
+    }
+}
+
+const uint8_t* World::deserializeNode(uint32_t nodeIndex, const glm::ivec3& position, const uint8_t* in) {
+    countNode(nodeIndex, -1);
+    nodes[nodeIndex].flags = *in++;
+    countNode(nodeIndex, 1);
+
+    const OctreeNode& node = nodes[nodeIndex];
+    if (node.isUniform()) {
+        MaterialId material;
+        std::memcpy(&material, in, sizeof(material));
+        nodes[nodeIndex].payload = material;
+        updateSummary(nodeIndex);
+        if (isSolidVoxel(material)) {
+            queueMesh(nodeIndex, position);
+        }
+        return in + sizeof(material);
+    }
+    if (node.isLeaf()) {
+        std::array<MaterialId, BRICK_VOLUME> voxels;
+        std::memcpy(voxels.data(), in, sizeof(voxels));
+        uint32_t payloadIndex = allocateLeafPayload(voxels[0]);
+        PaletteBrick& brick = leafPayloads[payloadIndex];
+        size_t brickBytes = brick.memoryUsage();
+        for (uint32_t i = 1; i < BRICK_VOLUME; ++i) {
+            if (voxels[i] != voxels[0]) {
+                brick.set(i, voxels[i]);
+            }
+        }
+        brickHeapBytes += brick.memoryUsage() - brickBytes;
+        nodes[nodeIndex].payload = payloadIndex;
+        updateSummary(nodeIndex);
+        queueMesh(nodeIndex, position);
+        return in + sizeof(voxels);
+    }
+
+    uint8_t childMask = *in++;
+    uint32_t childSize = (REGION_SIZE >> node.level) >> 1;
+    for (uint32_t i = 0; i < 8; ++i) {
+        if (childMask & (1u << i)) {
+            uint32_t child = addChild(nodeIndex, i);
+            in = deserializeNode(child, position + childOffset(i, childSize), in);
+        }
+    }
+    updateSummary(nodeIndex);
+    return in;
+}
+
+size_t World::compressedIndexBytes() const {
+    return compressedRegions.memoryUsage() +
+           compressedStore.capacity() * sizeof(std::shared_ptr<const CompressedRegion>) +
+           freeCompressedSlots.capacity() * sizeof(uint32_t);
+}
+
+size_t World::residentBytes() const {
+    return nodes.groupCount() * 8 * sizeof(OctreeNode) +
+           leafPayloads.size() * sizeof(PaletteBrick) + brickHeapBytes;
+}
+
+void World::keepViewResident(const glm::vec3& viewerPos) {
+    glm::ivec3 center = regionCoord(glm::ivec3(glm::floor(viewerPos)));
+    for (int dz = -VIEW_REGION_RADIUS; dz <= VIEW_REGION_RADIUS; ++dz) {
+        for (int dy = -VIEW_REGION_RADIUS; dy <= VIEW_REGION_RADIUS; ++dy) {
+            for (int dx = -VIEW_REGION_RADIUS; dx <= VIEW_REGION_RADIUS; ++dx) {
+                accessRegion(center + glm::ivec3(dx, dy, dz), false);
+            }
+        }
+    }
+}
+
+void World::enforceMemoryBudget() {
+    // Snapshots hold on to released storage, so compressing would not help
+    if (memoryBudget == 0 || liveSnapshots > 0) return;
+    size_t resident = residentBytes();
+    if (resident <= memoryBudget) return;
+
+    // Coldest first; regions accessed since the last update stay resident
+    std::vector<std::pair<uint32_t, glm::ivec3>> cold;
+    regions.forEach([&](const glm::ivec3& coord, uint32_t) {
+        uint32_t lastAccess = regions.lastAccess(coord);
+        if (lastAccess != accessFrame) {
+            cold.push_back({lastAccess, coord});
+        }
+    });
+    std::sort(cold.begin(), cold.end(),
+        [](const std::pair<uint32_t, glm::ivec3>& a, const std::pair<uint32_t, glm::ivec3>& b) {
+            return a.first < b.first;
+        });
+
+    for (const auto& [lastAccess, coord] : cold) {
+        if (resident <= memoryBudget) break;
+        compressRegion(coord);
+        resident = residentBytes();
+    }
+}
+
+void World::createChildren(uint32_t nodeIndex) {
+    if (nodes[nodeIndex].childBase != INVALID_INDEX) return;
+
+    uint32_t childBase = nodes.allocateGroup();
+    OctreeNode& node = nodes[nodeIndex];
+    node.childBase = childBase;
+    node.childMask = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+        OctreeNode& child = nodes[childBase + i];
+        child.level = node.level + 1;
+        child.flags = (child.level == BRICK_LEVEL) ? (NODE_LEAF | NODE_UNIFORM) : 0;
+    }
+}
+
+uint32_t World::addChild(uint32_t nodeIndex, uint32_t childIndex) {
+    // Children are allocated as a group, mark this one as present
+    createChildren(nodeIndex);
+    nodes[nodeIndex].childMask |= (1 << childIndex);
+    topologyVersion++;
+
+    uint32_t child = nodes[nodeIndex].child(childIndex);
+    countNode(child, 1);
+    return child;
+}
+
+void World::releaseChildren(uint32_t nodeIndex) {
+    OctreeNode& node = nodes[nodeIndex];
+    if (node.childBase == INVALID_INDEX) return;
+
+    uint32_t childBase = node.childBase;
+    node.childBase = INVALID_INDEX;
+    node.childMask = 0;
+    releaseGroup(childBase);
+}
+
+void World::releaseGroup(uint32_t childBase) {
+    // Shared groups stay alive until their last parent lets go
+    topologyVersion++;
+    if (nodes.refCount(childBase) > 1) {
+        nodes.release(childBase);
+        return;
+    }
+
+    // Absent children are default records without payloads, so all 8 can be visited
+    for (uint32_t i = 0; i < 8; ++i) {
+        uint32_t childIndex = childBase + i;
+        const OctreeNode& child = nodes[childIndex];
+        if (!child.isLeaf() && child.childBase != INVALID_INDEX) {
+            releaseGroup(child.childBase);
+        } else if (child.isLeaf() && !child.isUniform()) {
+            releaseLeafPayload(child.payload);
+        }
+
+        releaseMesh(childIndex);
+        dirtyNodes.erase(childIndex);
+    }
+    sharedGroups.erase(childBase);
+    nodes.release(childBase);
+    restartCompaction();
+}
+
+void World::makeChildrenUnique(uint32_t nodeIndex, const glm::ivec3& position) {
+    uint32_t sharedBase = nodes[nodeIndex].childBase;
+    if (sharedBase == INVALID_INDEX || nodes.refCount(sharedBase) == 1) return;
+
+    // Copy-on-write: clone the group, the clone takes its own references on
+    // everything below it. A group drawn through other parents stays drawn
+    // there and so do the groups below it, now shared with the clone.
+    bool drawnElsewhere = sharedGroups.count(sharedBase) != 0;
+    uint32_t childBase = nodes.allocateGroup();
+    for (uint32_t i = 0; i < 8; ++i) {
+        OctreeNode& child = nodes[childBase + i];
+        child = nodes[sharedBase + i];
+        if (!child.isLeaf() && child.childBase != INVALID_INDEX) {
+            nodes.addRef(child.childBase);
+            if (drawnElsewhere) {
+                sharedGroups.insert(child.childBase);
+            }
+        } else if (child.isLeaf() && !child.isUniform()) {
+            retainLeafPayload(child.payload);
+        }
+        if (child.isLeaf() && nodes[nodeIndex].hasChild(i)) {
+            // Otherwise the other references are snapshots, which are never
+            // drawn, so the clone takes over the mesh
+            uint32_t childSize = (REGION_SIZE >> child.level);
+            glm::ivec3 childPosition = position + childOffset(i, childSize);
+            if (drawnElsewhere) {
+                queueMesh(childBase + i, childPosition);
+            } else {
+                moveMesh(sharedBase + i, childBase + i, childPosition);
+            }
+        }
+    }
+
+    nodes[nodeIndex].childBase = childBase;
+    releaseGroup(sharedBase);
+}
+
+void World::setUniform(uint32_t nodeIndex, const glm::ivec3& position, uint32_t packedVoxel) {
+    const OctreeNode& node = nodes[nodeIndex];
+    if (node.isLeaf() && node.isUniform() && node.payload == packedVoxel) return;
+
+    // Drop whatever was stored below, the node now holds a single value
+    bool wasLeaf = node.isLeaf();
+    if (!wasLeaf) {
+        for (uint32_t i = 0; i < 8; ++i) {
+            if (node.hasChild(i)) {
+                countSubtree(node.child(i), -1);
+            }
+        }
+        releaseChildren(nodeIndex);
+        countNode(nodeIndex, -1);
+    } else if (!node.isUniform()) {
+        releaseLeafPayload(node.payload);
+    }
+
+    OctreeNode& leaf = nodes[nodeIndex];
+    leaf.flags = NODE_LEAF | NODE_UNIFORM;
+    leaf.payload = packedVoxel;
+    leaf.childBase = INVALID_INDEX;
+    leaf.childMask = 0;
+    updateSummary(nodeIndex);
+    if (!wasLeaf) {
+        countNode(nodeIndex, 1);
+    }
+    queueMesh(nodeIndex, position);
+}
+
+World::NodeSummary World::summarize(uint32_t nodeIndex) const {
+    const OctreeNode& node = nodes[nodeIndex];
+    NodeSummary summary;
+    summary.solidCount = node.isLeaf() ? solidCount(nodeIndex) : 0;
+    if (node.isUniform()) {
+        summary.minMaterial = static_cast<MaterialId>(node.payload);
+        summary.maxMaterial = summary.minMaterial;
+    } else if (node.isLeaf()) {
+        summary.minMaterial = MATERIAL_MAX;
+        summary.maxMaterial = MATERIAL_AIR;
+        leafPayloads[node.payload].forEachMaterial([&](MaterialId material, uint32_t) {
+            summary.minMaterial = std::min(summary.minMaterial, material);
+            summary.maxMaterial = std::max(summary.maxMaterial, material);
+        });
+    } else {
+        summary.minMaterial = node.childMask == 0xFF ? MATERIAL_MAX : MATERIAL_AIR;
+        summary.maxMaterial = MATERIAL_AIR;
+        for (uint32_t i = 0; i < 8; ++i) {
+            if (node.hasChild(i)) {
+                const OctreeNode& child = nodes[node.child(i)];
+                summary.solidCount += solidCount(node.child(i));
+                summary.minMaterial = std::min(summary.minMaterial, child.minMaterial);
+                summary.maxMaterial = std::max(summary.maxMaterial, child.maxMaterial);
+            }
+        }
+    }
+
+    uint32_t size = REGION_SIZE >> node.level;
+    summary.flags = (summary.solidCount != 0 ? NODE_ANY_SOLID : 0) |
+                    (summary.solidCount == size * size * size ? NODE_ALL_SOLID : 0);
+    return summary;
+}
+
+bool World::updateSummary(uint32_t nodeIndex) {
+    NodeSummary summary = summarize(nodeIndex);
+    OctreeNode& node = nodes[nodeIndex];
+    uint32_t count = node.isLeaf() ? node.payload : summary.solidCount;
+    if ((node.flags & NODE_OCCUPANCY) == summary.flags && node.payload == count &&
+        node.minMaterial == summary.minMaterial && node.maxMaterial == summary.maxMaterial) {
+        return false;
+    }
+    node.flags = (node.flags & ~NODE_OCCUPANCY) | summary.flags;
+    node.payload = count;
+    node.minMaterial = summary.minMaterial;
+    node.maxMaterial = summary.maxMaterial;
+    return true;
+}
+
+uint32_t World::solidCount(uint32_t nodeIndex) const {
+    const OctreeNode& node = nodes[nodeIndex];
+    if (node.isUniform()) {
+        uint32_t size = REGION_SIZE >> node.level;
+        return isSolidVoxel(node.payload) ? size * size * size : 0;
+    }
+    if (node.isLeaf()) {
+        return leafPayloads[node.payload].getSolidCount();
+    }
+    return node.payload;
+}
+
+bool World::isEnclosed(uint32_t nodeIndex, const glm::ivec3& position) const {
+    // Each face must meet a solid face of the neighbor across it. Uniform
+    // leaves are at least as large as the node, so they cover the whole
+    // face; missing nodes and unloaded or compressed regions count as open.
+    if (sharedBorderFaces(position, nodes[nodeIndex].level) != 0) return false;
+    NodeLocation location = locateNode(position, nodes[nodeIndex].level);
+    for (uint32_t face = 0; face < 6; ++face) {
+        glm::ivec3 direction(0);
+        direction[face >> 1] = (face & 1) ? 1 : -1;
+        uint32_t neighbor = findNeighbor(location, direction).nodeIndex;
+        if (neighbor == INVALID_INDEX || !nodes[neighbor].anySolid()) return false;
+        if (nodes[neighbor].allSolid()) continue;
+
+        // Partly solid leaves are always bricks
+        if (!nodes[neighbor].isLeaf() || !leafPayloads[nodes[neighbor].payload].isFaceSolid(face ^ 1)) return false;
+    }
+    return true;
+}
+
+NodeLocation World::locateNode(const glm::ivec3& pos, uint32_t level) const {
+    NodeLocation location;
+    location.region = regionCoord(pos);
+    location.level = level;
+    glm::ivec3 local = pos - regionOrigin(location.region);
+    uint32_t cellBits = 3 * (MAX_LEVEL - level);
+    location.code = static_cast<uint32_t>(mortonEncode(local.x, local.y, local.z) >> cellBits << cellBits);
+    descendLocation(location, -1);
+    return location;
+}
+
+NodeLocation World::findNeighbor(const NodeLocation& location, const glm::ivec3& direction) const {
+    NodeLocation neighbor = location;
+    moveCell(neighbor, direction);
+    descendLocation(neighbor, sharedLevel(location, neighbor));
+    return neighbor;
+}
+
+void World::findNeighbors(const NodeLocation& location, std::array<NodeLocation, 26>& neighbors) const {
+    // Axes move independently, so the single-axis steps are worked out once
+    // and combined. A neighbor's common ancestor with the cell is the
+    // shallowest one among its axes' steps.
+    constexpr uint32_t AXIS_BITS = static_cast<uint32_t>(spreadBits3(REGION_SIZE - 1));
+    struct AxisStep {
+        uint32_t field;     // The axis' bits of the moved code
+        int region;         // Region offset along the axis
+        int level;          // Deepest path entry shared with the cell
+    };
+    std::array<std::array<AxisStep, 3>, 3> steps;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int d = -1; d <= 1; ++d) {
+            NodeLocation moved;
+            moved.region = location.region;
+            moved.code = location.code;
+            moved.level = location.level;
+            glm::ivec3 direction(0);
+            direction[axis] = d;
+            moveCell(moved, direction);
+            steps[axis][d + 1] = AxisStep{moved.code & (AXIS_BITS << axis), moved.region[axis] - location.region[axis],
+                                          sharedLevel(location, moved)};
+        }
+    }
+
+    uint32_t count = 0;
+    for (int z = 0; z < 3; ++z) {
+        for (int y = 0; y < 3; ++y) {
+            for (int x = 0; x < 3; ++x) {
+                if (x == 1 && y == 1 && z == 1) continue;
+                const AxisStep& sx = steps[0][x];
+                const AxisStep& sy = steps[1][y];
+                const AxisStep& sz = steps[2][z];
+                NodeLocation& neighbor = neighbors[count++];
+                neighbor.region = location.region + glm::ivec3(sx.region, sy.region, sz.region);
+                neighbor.code = sx.field | sy.field | sz.field;
+                neighbor.level = location.level;
+
+                int start = std::min({sx.level, sy.level, sz.level});
+                std::copy_n(location.path.begin(), start + 1, neighbor.path.begin());
+                descendLocation(neighbor, start);
+            }
+        }
+    }
+}
+
+int World::sharedLevel(const NodeLocation& known, const NodeLocation& location) {
+    if (known.depth == 0 || known.region != location.region) return -1;
+
+    // Each group of three code bits is one level, counted from the bottom
+    int level = MAX_LEVEL;
+    for (uint32_t diff = known.code ^ location.code; diff != 0; diff >>= 3) {
+        --level;
+    }
+    return std::min({level, static_cast<int>(known.level), static_cast<int>(location.level),
+                     static_cast<int>(known.depth) - 1});
+}
+
+void World::descendLocation(NodeLocation& location, int startLevel) const {
+    if (startLevel < 0) {
+        location.path[0] = regions.find(location.region);
+        if (location.path[0] == INVALID_INDEX) {
+            location.depth = 0;
+            location.nodeIndex = INVALID_INDEX;
+            return;
+        }
+        startLevel = 0;
+    }
+
+    uint32_t level = static_cast<uint32_t>(startLevel);
+    uint32_t current = location.path[level];
+    while (level < location.level && !nodes[current].isLeaf()) {
+        const OctreeNode& node = nodes[current];
+        uint32_t octant = (location.code >> (3 * (MAX_LEVEL - 1 - level))) & 7;
+        if (!node.hasChild(octant)) {
+            location.depth = level + 1;
+            location.nodeIndex = INVALID_INDEX;
+            return;
+        }
+        current = node.child(octant);
+        location.path[++level] = current;
+    }
+    location.depth = level + 1;
+    location.nodeIndex = current;
+}
+
+PaletteBrick& World::writableBrick(uint32_t nodeIndex) {
+    OctreeNode& node = nodes[nodeIndex];
+    if (node.isUniform()) {
+        // Allocate the brick on first write, expanding the uniform value
+        uint32_t payloadIndex = allocateLeafPayload(node.payload);
+        node.flags &= ~NODE_UNIFORM;
+        node.payload = payloadIndex;
+    } else if (payloadRefs[node.payload] > 1) {
+        // Copy-on-write, the brick is shared with identical bricks elsewhere
+        node.payload = copyLeafPayload(node.payload);
+    }
+    return leafPayloads[node.payload];
+}
+
+uint32_t World::allocateLeafPayload(uint32_t packedVoxel) {
+    uint32_t payloadIndex = leafPayloads.allocate(packedVoxel);
+    if (payloadIndex >= payloadRefs.size()) {
+        payloadRefs.resize(payloadIndex + 1);
+    }
+    payloadRefs[payloadIndex] = 1;
+    brickHeapBytes += leafPayloads[payloadIndex].memoryUsage() - sizeof(PaletteBrick);
+    return payloadIndex;
+}
+
+uint32_t World::copyLeafPayload(uint32_t payloadIndex) {
+    // Slab slots never move, so the source stays valid while the copy is allocated
+    uint32_t copyIndex = leafPayloads.allocate(leafPayloads[payloadIndex]);
+    if (copyIndex >= payloadRefs.size()) {
+        payloadRefs.resize(copyIndex + 1);
+    }
+    payloadRefs[copyIndex] = 1;
+    brickHeapBytes += leafPayloads[copyIndex].memoryUsage() - sizeof(PaletteBrick);
+    releaseLeafPayload(payloadIndex);
+    return copyIndex;
+}
+
+void World::releaseLeafPayload(uint32_t payloadIndex) {
+    if (--payloadRefs[payloadIndex] == 0) {
+        brickHeapBytes -= leafPayloads[payloadIndex].memoryUsage() - sizeof(PaletteBrick);
+        leafPayloads.deallocate(payloadIndex);
+        restartCompaction();
+    }
+}
+
+const MeshData* World::getMesh(uint32_t nodeIndex) const {
+    auto it = meshes.find(nodeIndex);
+    return it != meshes.end() ? &it->second : nullptr;
+}
+
+uint32_t World::findNode(const glm::ivec3& position, bool create, uint32_t* path, uint32_t startLevel) {
+    // A caller resuming below the root passes the path down to startLevel
+    uint32_t current = startLevel != 0 ? path[startLevel] : accessRegion(regionCoord(position), create);
+    if (current == INVALID_INDEX) {
+        return INVALID_INDEX;
+    }
+
+    // Descend to the brick level; bricks are indexed directly by the caller
+    uint32_t size = REGION_SIZE >> startLevel;
+    if (path) path[startLevel] = current;
+    while (nodes[current].level < BRICK_LEVEL) {
+        glm::ivec3 origin = nodeOrigin(position, size);
+        if (nodes[current].isLeaf()) {
+            if (!create) {
+                return current;  // Empty or collapsed region above the brick level
+            }
+            subdivideNode(current, origin);
+        }
+
+        size >>= 1;
+        uint32_t index = childIndex(position, size);
+
+        if (!nodes[current].hasChild(index)) {
+            if (!create) {
+                return INVALID_INDEX;
+            }
+            
+            makeChildrenUnique(current, origin);
+            addChild(current, index);
+        } else {
+            // The path is about to be edited, so it must not be shared
+            makeChildrenUnique(current, origin);
+        }
+
+        current = nodes[current].child(index);
+        if (path) path[nodes[current].level] = current;
+    }
+
+    return current;
+}
+
+void World::subdivideNode(uint32_t nodeIndex, const glm::ivec3& position) {
+    // Bricks are the finest level; only collapsed leaves above them can split
+    if (nodeIndex == INVALID_INDEX) return;
+    const OctreeNode& node = nodes[nodeIndex];
+    if (!node.isLeaf() || node.level >= BRICK_LEVEL) return;
+
+    // Convert to internal node, its children carry the geometry from now on
+    uint32_t value = node.payload;
+    releaseMesh(nodeIndex);
+    dirtyNodes.erase(nodeIndex);
+    // The summary carries over, the children hold the same voxels
+    countNode(nodeIndex, -1);
+    nodes[nodeIndex].flags &= NODE_OCCUPANCY;
+    nodes[nodeIndex].payload = 0;
+    countNode(nodeIndex, 1);
+    scheduleCompaction();
+    topologyVersion++;
+
+    // An empty leaf needs no children; they are created on demand by findNode
+    if (!isSolidVoxel(value)) {
+        return;
+    }
+
+    // Create child nodes that inherit the uniform value
+    createChildren(nodeIndex);
+    OctreeNode& parent = nodes[nodeIndex];
+    parent.childMask = 0xFF;
+    uint32_t childSize = (REGION_SIZE >> parent.level) >> 1;
+    for (uint32_t i = 0; i < 8; ++i) {
+        uint32_t child = parent.child(i);
+        nodes[child].flags = NODE_LEAF | NODE_UNIFORM | NODE_OCCUPANCY;
+        nodes[child].payload = value;
+        nodes[child].minMaterial = static_cast<MaterialId>(value);
+        nodes[child].maxMaterial = static_cast<MaterialId>(value);
+        countNode(child, 1);
+        queueMesh(child, position + childOffset(i, childSize));
+    }
+    updateSummary(nodeIndex);
+}
+
+bool World::optimizeNode(uint32_t nodeIndex, const glm::ivec3& position) {
+    if (nodeIndex == INVALID_INDEX) return false;
+    
+    const OctreeNode& node = nodes[nodeIndex];
+    if (node.isLeaf()) {
+        if (node.isUniform()) return false;
+
+        // The palette tracks live values, so a single entry means all voxels match
+        const PaletteBrick& brick = leafPayloads[node.payload];
+        if (!brick.isUniform()) return false;
+        uint32_t value = brick.uniformValue();
+
+        // A uniform brick is represented by its value alone
+        releaseLeafPayload(node.payload);
+        OctreeNode& leaf = nodes[nodeIndex];
+        leaf.flags |= NODE_UNIFORM;
+        leaf.payload = value;
+        return true;
+    }
+
+    // An internal node collapses once all eight octants hold the same
+    // uniform value, missing children count as air
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+        uint32_t childValue = 0;
+        if (node.hasChild(i)) {
+            const OctreeNode& child = nodes[node.child(i)];
+            if (!child.isLeaf() || !child.isUniform()) return false;
+            childValue = child.payload;
+        }
+        if (i == 0) {
+            value = childValue;
+        } else if (childValue != value) {
+            return false;
+        }
+    }
+
+    setUniform(nodeIndex, position, value);
+    return true;
+}
+
+bool World::optimizeNodes() {
+    if (regions.size() == 0) return false;
+
+    // Post-order, so a node is only considered once its children are optimized
+    bool anyOptimized = false;
+    traverse(
+        [&](const NodeVisit& visit) {
+            // Shared subtrees are left alone, as in collapseDirtyPaths
+            const OctreeNode& node = nodes[visit.nodeIndex];
+            return node.isLeaf() || node.childBase == INVALID_INDEX || nodes.refCount(node.childBase) == 1;
+        },
+        [&](const NodeVisit& visit) {
+            if (optimizeNode(visit.nodeIndex, visit.position)) {
+                anyOptimized = true;
+            }
+        });
+    collapseCandidates.clear();
+    return anyOptimized;
+}
+
+void World::markCollapseCandidate(const glm::ivec3& position, uint32_t level) {
+    collapseCandidates.insert(CollapseCandidate{position, level});
+}
+
+bool World::collapseDirtyPaths() {
+    if (collapseCandidates.empty()) return false;
+
+    bool anyOptimized = false;
+    std::array<uint32_t, MAX_LEVEL + 1> path;
+    for (const CollapseCandidate& candidate : collapseCandidates) {
+        const glm::ivec3& position = candidate.position;
+        uint32_t level = candidate.level;
+        glm::ivec3 coord = regionCoord(position);
+        uint32_t current = regions.find(coord);
+        if (current == INVALID_INDEX) continue;  // Released earlier in this pass
+
+        // Walk down to the edited node. Shared groups are left alone, a
+        // collapse there would change every subtree referencing them.
+        uint32_t depth = 0;
+        uint32_t size = REGION_SIZE;
+        path[depth++] = current;
+        while (!nodes[current].isLeaf() && nodes[current].level < level) {
+            const OctreeNode& node = nodes[current];
+            size >>= 1;
+            uint32_t index = childIndex(position, size);
+            if (!node.hasChild(index) || nodes.refCount(node.childBase) > 1) break;
+            current = node.child(index);
+            path[depth++] = current;
+        }
+
+        // Collapse bottom-up. The edited node itself may already be uniform,
+        // above it the first node that stays subdivided ends the chain.
+        for (uint32_t i = depth; i-- > 0;) {
+            if (optimizeNode(path[i], nodeOrigin(position, REGION_SIZE >> i))) {
+                anyOptimized = true;
+            }
+            const OctreeNode& node = nodes[path[i]];
+            if (!node.isLeaf() || !node.isUniform()) break;
         }
 
-        if (commandPool != VK_NULL_HANDLE) {
-            vkDestroyCommandPool(device, commandPool, nullptr);
-            commandPool = VK_NULL_HANDLE;
+        // A region cleared down to air holds nothing worth keeping
+        const OctreeNode& root = nodes[path[0]];
+        if (root.isLeaf() && root.isUniform() && root.payload == 0) {
+            releaseRegion(coord);
+            anyOptimized = true;
         }
     }
 
-    // Clean up octree
-    root.reset();
+    collapseCandidates.clear();
+    return anyOptimized;
+}
 
-    std::cout << "World: Cleanup complete" << std::endl;
+size_t World::getMemoryUsage() const {
+    WorldStats current = getStats();
+    return sizeof(World) + current.nodeBytes + current.payloadBytes + regions.memoryUsage() + materials.memoryUsage() +
+           compressedIndexBytes() + current.compressedBytes + current.compressedRegions * sizeof(CompressedRegion);
 }
 
-void World::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
-    OctreeNode* node = findNode(pos, true);
-    if (!node) return;
+uint32_t World::getNodeCount() const {
+    return stats.leafNodes + stats.internalNodes;
+}
 
-    // Calculate local position within the node
-    glm::ivec3 localPos = pos - node->position;
-    uint32_t index = (localPos.x & 1) | ((localPos.y & 1) << 1) | ((localPos.z & 1) << 2);
+WorldStats World::getStats() const {
+    WorldStats snapshot = stats;
+    snapshot.nodeBytes = nodes.memoryUsage();
+    snapshot.payloadBytes = leafPayloads.memoryUsage() + payloadRefs.capacity() * sizeof(uint32_t) + brickHeapBytes;
+    snapshot.residentBytes = residentBytes();
+    return snapshot;
+}
 
-    // Initialize data vector if empty
-    if (node->nodeData.leaf.data.empty()) {
-        node->nodeData.leaf.data.resize(8, 0);  // Initialize with 8 empty voxels
+void World::countNode(uint32_t nodeIndex, int delta) {
+    const OctreeNode& node = nodes[nodeIndex];
+    stats.nodesPerLevel[node.level] += delta;
+    if (node.isLeaf()) {
+        stats.leafNodes += delta;
+    } else {
+        stats.internalNodes += delta;
     }
+}
 
-    // Pack voxel data into uint32_t
-    uint32_t packedVoxel = (voxel.color & 0xFFFFFF00) | (voxel.type & 0xFF);
-    node->nodeData.leaf.data[index] = packedVoxel;
-    node->needsUpdate = true;
+void World::countSubtree(uint32_t nodeIndex, int delta) {
+    uint32_t size = 1u << (MAX_LEVEL - nodes[nodeIndex].level);
+    traverseOctree<MAX_LEVEL + 1>(nodes, NodeVisit{nodeIndex, glm::ivec3(0), size}, [&](const NodeVisit& visit) {
+        countNode(visit.nodeIndex, delta);
+        return true;
+    });
 }
 
-Voxel World::getVoxel(const glm::ivec3& pos) const {
-    const OctreeNode* node = findNode(pos);
-    if (!node || node->nodeData.leaf.data.empty()) {
-        return Voxel{0, 0};  // Return empty voxel if node doesn't exist
+#ifndef NDEBUG
+bool World::validateStats() const {
+    WorldStats expected;
+    bool summariesValid = true;
+    traverse([&](const NodeVisit& visit) {
+        const OctreeNode& node = nodes[visit.nodeIndex];
+        NodeSummary summary = summarize(visit.nodeIndex);
+        if ((node.flags & NODE_OCCUPANCY) != summary.flags || solidCount(visit.nodeIndex) != summary.solidCount ||
+            node.minMaterial != summary.minMaterial || node.maxMaterial != summary.maxMaterial) {
+            summariesValid = false;
+        }
+        expected.nodesPerLevel[node.level]++;
+        if (node.isLeaf()) {
+            expected.leafNodes++;
+        } else {
+            expected.internalNodes++;
+        }
+        return true;
+    });
+    for (const auto& [node, meshData] : meshes) {
+        if (meshData.memorySize != 0) {
+            expected.meshCount++;
+            expected.meshBytes += meshData.memorySize;
+        }
     }
 
-    // Calculate local position within the node
-    glm::ivec3 localPos = pos - node->position;
-    uint32_t index = (localPos.x & 1) | ((localPos.y & 1) << 1) | ((localPos.z & 1) << 2);
-
-    // Unpack voxel data from uint32_t
-    uint32_t packedVoxel = node->nodeData.leaf.data[index];
-    return Voxel{
-        static_cast<uint32_t>(packedVoxel & 0xFF),           // type
-        static_cast<uint32_t>(packedVoxel & 0xFFFFFF00)      // color
-    };
+    WorldStats current = getStats();
+    bool valid = expected.nodesPerLevel == current.nodesPerLevel &&
+                 expected.leafNodes == current.leafNodes &&
+                 expected.internalNodes == current.internalNodes &&
+                 expected.meshCount == current.meshCount &&
+                 expected.meshBytes == current.meshBytes &&
+                 calculateMemoryUsage() == getMemoryUsage() &&
+                 summariesValid;
+    if (!valid) {
+        std::cerr << "World: Incremental stats out of sync (nodes " << current.leafNodes + current.internalNodes
+                  << " vs " << expected.leafNodes + expected.internalNodes << ", memory " << getMemoryUsage()
+                  << " vs " << calculateMemoryUsage() << ", summaries " << (summariesValid ? "ok" : "stale")
+                  << ")" << std::endl;
+    }
+    assert(valid);
+    return valid;
 }
+#endif
 
-void World::updateLOD(const glm::vec3& viewerPos) {
-    if (!root) return;
-
-    // Update LOD levels based on distance from viewer
-    std::function<void(OctreeNode*, const glm::vec3&)> updateNode = 
-        [&](OctreeNode* node, const glm::vec3& pos) {
-            if (!node) return;
-
-            // Calculate distance to viewer
-            glm::vec3 center = glm::vec3(node->position) + glm::vec3(node->size / 2);
-            float distance = glm::length(center - pos);
-
-            // Determine desired LOD level based on distance
-            float factor = distance / (node->size * 2.0f);
-            uint32_t desiredLevel = static_cast<uint32_t>(glm::log2(factor));
-            desiredLevel = glm::clamp(desiredLevel, 0u, MAX_LEVEL);
-
-            // Split or merge based on desired level
-            if (desiredLevel > node->level && !node->isLeaf) {
-                // Node is too detailed, try to merge
-                optimizeNode(node);
-            } else if (desiredLevel < node->level && node->isLeaf) {
-                // Node needs more detail, split
-                subdivideNode(node);
-            }
-
-            // Recursively update children
-            if (!node->isLeaf) {
-                for (uint8_t i = 0; i < 8; ++i) {
-                    if (node->childMask & (1 << i)) {
-                        updateNode(node->nodeData.internal.children[i].get(), pos);
-                    }
-                }
-            }
-        };
-
-    updateNode(root.get(), viewerPos);
+bool World::setHugePages(bool enabled) {
+    if (!nodes.setHugePages(enabled) || !leafPayloads.setHugePages(enabled)) {
+        std::cerr << "World: Huge pages must be configured before any nodes are allocated" << std::endl;
+        return false;
+    }
+    return true;
 }
 
-void World::generateMeshes(const glm::vec3& viewerPos) {
-    if (!root) return;
-
-    // Queue of nodes that need mesh updates
-    std::vector<OctreeNode*> updateQueue;
-
-    // Collect nodes that need updates
-    std::function<void(OctreeNode*)> collectNodes = [&](OctreeNode* node) {
-        if (!node) return;
-
-        if (node->needsUpdate) {
-            updateQueue.push_back(node);
-        }
-
-        if (!node->isLeaf) {
-            for (uint8_t i = 0; i < 8; ++i) {
-                if (node->childMask & (1 << i)) {
-                    collectNodes(node->nodeData.internal.children[i].get());
-                }
-            }
-        }
-    };
-
-    collectNodes(root.get());
+void World::setDeduplication(bool enabled) {
+    deduplicate = enabled;
+    if (enabled) {
+        compactionPending = true;
+    }
+}
 
-    // Sort nodes by distance to viewer (closest first)
-    std::sort(updateQueue.begin(), updateQueue.end(),
-        [&viewerPos](const OctreeNode* a, const OctreeNode* b) {
-            glm::vec3 centerA = glm::vec3(a->position) + glm::vec3(a->size / 2);
-            glm::vec3 centerB = glm::vec3(b->position) + glm::vec3(b->size / 2);
-            float distA = glm::length(centerA - viewerPos);
-            float distB = glm::length(centerB - viewerPos);
-            return distA < distB;
+std::shared_ptr<const WorldSnapshot> World::createSnapshot() {
+    // Readers may drop the snapshot on any thread, so the deleter only
+    // parks it for the editing thread to release
+    std::shared_ptr<WorldSnapshot> snapshot(new WorldSnapshot(nodes, leafPayloads),
+        [this](WorldSnapshot* retired) {
+            std::lock_guard<std::mutex> lock(retiredSnapshotsMutex);
+            retiredSnapshots.push_back(retired);
         });
 
-    // Generate meshes for nodes that need updates
-    for (auto* node : updateQueue) {
-        if (generateMeshForNode(node)) {
-            node->needsUpdate = false;
+    // Each root is copied into a group of its own that holds a reference on
+    // everything below, so the next edit of a path copies it first
+    regions.forEach([&](const glm::ivec3& coord, uint32_t rootIndex) {
+        uint32_t copy = nodes.allocateGroup();
+        OctreeNode& root = nodes[copy];
+        root = nodes[rootIndex];
+        if (!root.isLeaf() && root.childBase != INVALID_INDEX) {
+            nodes.addRef(root.childBase);
+        } else if (root.isLeaf() && !root.isUniform()) {
+            retainLeafPayload(root.payload);
         }
-    }
+        snapshot->regions.insert(coord, copy);
+    });
+
+    // Compressed regions are immutable, sharing the stream is enough
+    compressedRegions.forEach([&](const glm::ivec3& coord, uint32_t slot) {
+        snapshot->compressedRegions.emplace_back(coord, compressedStore[slot]);
+    });
+    liveSnapshots++;
+    topologyVersion++;  // Every path is shared now, edits must copy it again
+    return snapshot;
 }
 
-void World::prepareFrame(const Camera& camera) {
-    if (renderer) {
-        renderer->prepareFrame(camera, *this);
+void World::releaseRetiredSnapshots() {
+    std::vector<WorldSnapshot*> retired;
+    {
+        std::lock_guard<std::mutex> lock(retiredSnapshotsMutex);
+        retired.swap(retiredSnapshots);
     }
-}
 
-void World::render(VkCommandBuffer commandBuffer) {
-    if (renderer) {
-        renderer->recordCommands(commandBuffer);
+    for (WorldSnapshot* snapshot : retired) {
+        snapshot->regions.forEach([&](const glm::ivec3&, uint32_t rootIndex) {
+            releaseGroup(rootIndex);
+        });
+        delete snapshot;
+        liveSnapshots--;
     }
 }
 
-void World::setDebugVisualization(bool enabled) {
-    if (renderer) {
-        renderer->setDebugVisualization(enabled);
+void World::compact() {
+    if (liveSnapshots > 0) {
+        std::cerr << "World: Cannot compact while snapshots are alive" << std::endl;
+        return;
     }
+    compactionStack.clear();
+    compactionPending = true;
+    while (!compactStep(UINT32_MAX)) {}
 }
 
-bool World::isDebugVisualizationEnabled() const {
-    return renderer ? renderer->isDebugVisualizationEnabled() : false;
+void World::restartCompaction() {
+    // Any structural edit may free slots referenced by the canonical tables
+    if (!deduplicate || compacting) return;
+    compactionStack.clear();
+    compactionPending = true;
 }
 
-OctreeNode* World::findNode(const glm::ivec3& position, bool create) {
-    if (!root) {
-        if (create) {
-            root = std::make_unique<OctreeNode>();
-            root->position = glm::ivec3(0);
-            root->size = 1u << MAX_LEVEL;
-            root->level = 0;
-            root->isLeaf = true;
-            return root.get();
-        }
-        return nullptr;
-    }
+void World::scheduleCompaction() {
+    // Edits that free no slots leave the canonical tables usable, every match
+    // is confirmed by comparing contents, so a running pass is left to finish
+    // and the next one picks up the change
+    compactionPending = true;
+}
 
-    OctreeNode* current = root.get();
-    uint32_t size = 1u << MAX_LEVEL;
-    uint32_t level = 0;
+bool World::compactStep(uint32_t groupBudget) {
+    if (regions.size() == 0) return true;
 
-    while (current && !current->isLeaf && level < MAX_LEVEL) {
-        size >>= 1;
-        glm::ivec3 localPos = (position - current->position) / static_cast<int>(size);
-        uint32_t index = (localPos.x & 1) | ((localPos.y & 1) << 1) | ((localPos.z & 1) << 2);
+    // Merging rewrites shared nodes in place, which snapshot readers would see
+    if (liveSnapshots > 0) return false;
 
-        if (!(current->childMask & (1 << index))) {
-            if (!create) {
-                return nullptr;
-            }
-            
-            // Create new child node
-            auto& child = current->nodeData.internal.children[index];
-            child = std::make_unique<OctreeNode>();
-            child->position = current->position + glm::ivec3(
-                (index & 1) ? size : 0,
-                (index & 2) ? size : 0,
-                (index & 4) ? size : 0
-            );
-            child->size = size;
-            child->level = level + 1;
-            child->isLeaf = true;
-            current->childMask |= (1 << index);
-        }
+    if (compactionStack.empty()) {
+        if (!compactionPending) return true;
 
-        current = current->nodeData.internal.children[index].get();
-        level++;
+        // Start a new pass from the region roots, groups are shared across regions too
+        compactionPending = false;
+        canonicalGroups.clear();
+        canonicalBricks.clear();
+        compactedGroups.clear();
+        mergedGroups = 0;
+        mergedBricks = 0;
+        regions.forEach([&](const glm::ivec3& coord, uint32_t rootIndex) {
+            compactionStack.push_back({rootIndex, regionOrigin(coord), 0});
+        });
     }
 
-    return current;
-}
-
-const OctreeNode* World::findNode(const glm::ivec3& position) const {
-    if (!root) return nullptr;
-
-    const OctreeNode* current = root.get();
-    uint32_t size = 1u << MAX_LEVEL;
-    uint32_t level = 0;
-
-    while (current && !current->isLeaf && level < MAX_LEVEL) {
-        size >>= 1;
-        glm::ivec3 localPos = (position - current->position) / static_cast<int>(size);
-        uint32_t index = (localPos.x & 1) | ((localPos.y & 1) << 1) | ((localPos.z & 1) << 2);
+    // Post-order walk: a group can only be hashed once its children are canonical
+    compacting = true;
+    while (!compactionStack.empty() && groupBudget > 0) {
+        CompactionFrame& frame = compactionStack.back();
+        const OctreeNode& node = nodes[frame.nodeIndex];
+        if (node.isLeaf() || node.childBase == INVALID_INDEX) {
+            compactionStack.pop_back();
+            continue;
+        }
 
-        if (!(current->childMask & (1 << index))) {
-            return nullptr;
+        if (frame.nextChild < 8) {
+            uint32_t i = frame.nextChild++;
+            const OctreeNode& child = nodes[node.child(i)];
+            if (node.hasChild(i) && !child.isLeaf() && child.childBase != INVALID_INDEX &&
+                compactedGroups.count(child.childBase) == 0) {
+                glm::ivec3 childPosition = frame.position + childOffset(i, REGION_SIZE >> child.level);
+                compactionStack.push_back({node.child(i), childPosition, 0});
+            }
+            continue;
         }
 
-        current = current->nodeData.internal.children[index].get();
-        level++;
+        compactGroup(frame.nodeIndex, frame.position);
+        compactionStack.pop_back();
+        groupBudget--;
     }
+    compacting = false;
 
-    return current;
-}
-
-void World::subdivideNode(OctreeNode* node) {
-    if (!node || !node->isLeaf || node->level >= MAX_LEVEL) return;
+    if (!compactionStack.empty()) return false;
 
-    // Convert to internal node
-    node->isLeaf = false;
-    std::vector<uint32_t> leafData;
-    if (!node->nodeData.leaf.data.empty()) {
-        leafData = node->nodeData.leaf.data;  // Save the data before moving
+    if (mergedGroups > 0 || mergedBricks > 0) {
+        std::cout << "World: Deduplication merged " << mergedGroups << " node groups and "
+                  << mergedBricks << " bricks" << std::endl;
     }
-    node->nodeData.leaf.~LeafData();  // Explicitly destruct leaf data
-    new (&node->nodeData.internal) InternalData();
+    return true;
+}
 
-    // Create child nodes
-    uint32_t childSize = node->size >> 1;
+void World::compactGroup(uint32_t nodeIndex, const glm::ivec3& position) {
+    uint32_t childBase = nodes[nodeIndex].childBase;
+
+    // Bricks first, the group's identity includes its children's payloads
     for (uint32_t i = 0; i < 8; ++i) {
-        auto& child = node->nodeData.internal.children[i];
-        child = std::make_unique<OctreeNode>();
-        child->position = node->position + glm::ivec3(
-            (i & 1) ? childSize : 0,
-            (i & 2) ? childSize : 0,
-            (i & 4) ? childSize : 0
-        );
-        child->size = childSize;
-        child->level = node->level + 1;
-        child->isLeaf = true;
-        node->childMask |= (1 << i);
-        
-        // Copy voxel data if it exists
-        if (!leafData.empty()) {
-            child->nodeData.leaf.data.resize(8, 0);
-            child->nodeData.leaf.data[i] = leafData[i];
+        OctreeNode& child = nodes[childBase + i];
+        if (child.isLeaf() && !child.isUniform()) {
+            child.payload = canonicalBrick(child.payload);
         }
     }
 
-    node->needsUpdate = true;
-}
-
-void World::optimizeNode(OctreeNode* node) {
-    if (!node) return;
-    
-    if (node->isLeaf) {
-        if (!node->nodeData.leaf.data.empty()) {
-            // Check if all voxels are the same
-            uint32_t firstVoxel = node->nodeData.leaf.data[0];
-            bool allSame = true;
-            
-            for (size_t i = 1; i < node->nodeData.leaf.data.size(); ++i) {
-                if (node->nodeData.leaf.data[i] != firstVoxel) {
-                    allSame = false;
-                    break;
-                }
-            }
-            
-            if (allSame) {
-                // If all voxels are empty (type == 0)
-                if ((firstVoxel & 0xFF) == 0) {
-                    node->nodeData.leaf.data.clear();
-                    node->nodeData.leaf.runs.clear();
-                    node->isOptimized = true;
-                    node->optimizedValue = 0;
-                } else {
-                    // Otherwise, keep one voxel and mark as optimized
-                    node->isOptimized = true;
-                    node->optimizedValue = firstVoxel;
-                }
-            }
+    auto result = canonicalGroups.emplace(hashGroup(childBase), childBase);
+    uint32_t canonical = result.first->second;
+    if (!result.second && canonical != childBase && groupsEqual(canonical, childBase)) {
+        nodes.addRef(canonical);
+        nodes[nodeIndex].childBase = canonical;
+        releaseGroup(childBase);
+        childBase = canonical;
+        mergedGroups++;
+
+        // The canonical bricks on the subtree's border were culled against
+        // the neighbors of one placement, mesh them again with those faces open
+        if (sharedGroups.insert(canonical).second) {
+            uint32_t size = REGION_SIZE >> nodes[nodeIndex].level;
+            glm::ivec3 end = position + glm::ivec3(static_cast<int>(size));
+            traverseOctree<MAX_LEVEL + 1>(nodes, NodeVisit{nodeIndex, position, size},
+                [&](const NodeVisit& visit) {
+                    const OctreeNode& node = nodes[visit.nodeIndex];
+                    if (!node.anySolid()) return false;
+                    glm::ivec3 visitEnd = visit.position + glm::ivec3(static_cast<int>(visit.size));
+                    bool onBorder = false;
+                    for (int axis = 0; axis < 3; ++axis) {
+                        onBorder |= visit.position[axis] == position[axis] || visitEnd[axis] == end[axis];
+                    }
+                    if (!onBorder) return false;
+                    if (node.isLeaf()) {
+                        queueMesh(visit.nodeIndex, visit.position);
+                    }
+                    return true;
+                });
         }
     }
+    compactedGroups.insert(childBase);
 }
 
-bool World::optimizeNodes() {
-    if (!root) return false;
-
-    bool anyOptimized = false;
-    std::function<void(OctreeNode*)> optimizeRecursive = [&](OctreeNode* node) {
-        if (!node || node->isLeaf) return;
-
-        // First optimize children
-        for (uint8_t i = 0; i < 8; ++i) {
-            if (node->childMask & (1 << i)) {
-                optimizeRecursive(node->nodeData.internal.children[i].get());
-            }
-        }
+uint32_t World::canonicalBrick(uint32_t payloadIndex) {
+    const PaletteBrick& brick = leafPayloads[payloadIndex];
+    auto result = canonicalBricks.emplace(brick.contentHash(), payloadIndex);
+    uint32_t canonical = result.first->second;
+    if (result.second || canonical == payloadIndex) {
+        return payloadIndex;
+    }
 
-        // Then try to optimize this node
-        bool wasLeaf = node->isLeaf;
-        optimizeNode(node);
-        if (node->isLeaf && !wasLeaf) {
-            anyOptimized = true;
-        }
-    };
+    // Hash collisions are left alone rather than chained
+    if (!leafPayloads[canonical].sameVoxels(brick)) {
+        return payloadIndex;
+    }
 
-    optimizeRecursive(root.get());
-    return anyOptimized;
+    retainLeafPayload(canonical);
+    releaseLeafPayload(payloadIndex);
+    mergedBricks++;
+    return canonical;
 }
 
-size_t World::getMemoryUsage() const {
-    return calculateMemoryUsage();
+uint64_t World::hashGroup(uint32_t childBase) const {
+    // Every flag bit is content, mesh dirtiness lives in the queue
+    uint64_t hash = FNV_OFFSET;
+    for (uint32_t i = 0; i < 8; ++i) {
+        const OctreeNode& node = nodes[childBase + i];
+        hash = hashCombine(hash, node.childBase);
+        hash = hashCombine(hash, node.payload);
+        hash = hashCombine(hash, node.childMask | (node.flags << 8) | (node.level << 16));
+    }
+    return hash;
 }
 
-uint32_t World::getNodeCount() const {
-    return static_cast<uint32_t>(countNodes(false));
+bool World::groupsEqual(uint32_t a, uint32_t b) const {
+    for (uint32_t i = 0; i < 8; ++i) {
+        const OctreeNode& x = nodes[a + i];
+        const OctreeNode& y = nodes[b + i];
+        if (x.childBase != y.childBase || x.payload != y.payload || x.childMask != y.childMask ||
+            x.flags != y.flags || x.level != y.level) {
+            return false;
+        }
+    }
+    return true;
 }
 
 size_t World::calculateMemoryUsage() const {
     size_t total = sizeof(World);
-    if (root) {
-        std::function<size_t(const OctreeNode*)> calcNodeMemory = 
-            [&calcNodeMemory](const OctreeNode* node) -> size_t {
-                if (!node) return 0;
-
-                size_t memory = sizeof(OctreeNode);
-                
-                if (node->isLeaf) {
-                    memory += node->nodeData.leaf.data.capacity() * sizeof(uint32_t);
-                    memory += node->nodeData.leaf.runs.capacity() * sizeof(VoxelRun);
-                } else {
-                    for (uint8_t i = 0; i < 8; ++i) {
-                        if (node->childMask & (1 << i)) {
-                            memory += calcNodeMemory(node->nodeData.internal.children[i].get());
-                        }
-                    }
-                }
-
-                return memory;
-            };
-
-        total += calcNodeMemory(root.get());
+    total += nodes.memoryUsage();
+    total += leafPayloads.memoryUsage() + payloadRefs.capacity() * sizeof(uint32_t);
+    total += regions.memoryUsage() + compressedIndexBytes() + materials.memoryUsage();
+    for (const auto& region : compressedStore) {
+        if (region) {
+            total += region->data.capacity() + sizeof(CompressedRegion);
+        }
     }
+    leafPayloads.forEach([&total](uint32_t, const PaletteBrick& brick) {
+        total += brick.memoryUsage() - sizeof(PaletteBrick);  // Slot itself is counted above
+    });
     return total;
 }
 
-size_t World::countNodes(bool activeOnly) const {
-    if (!root) return 0;
-
-    std::function<size_t(const OctreeNode*)> countRecursive = 
-        [activeOnly, &countRecursive](const OctreeNode* node) -> size_t {
-            if (!node) return 0;
-
-            size_t count = 1;
-            if (!node->isLeaf) {
-                for (uint8_t i = 0; i < 8; ++i) {
-                    if (!activeOnly || (node->childMask & (1 << i))) {
-                        count += countRecursive(node->nodeData.internal.children[i].get());
-                    }
-                }
-            }
-            return count;
-        };
-
-    return countRecursive(root.get());
+size_t World::countNodes() const {
+    size_t count = 0;
+    traverse([&count](const NodeVisit&) {
+        count++;
+        return true;
+    });
+    return count;
 }
 
 size_t World::countNodesByLevel(uint32_t level) const {
-    if (!root) return 0;
-
-    std::function<size_t(const OctreeNode*)> countRecursive = 
-        [level, &countRecursive](const OctreeNode* node) -> size_t {
-            if (!node) return 0;
-
-            size_t count = (node->level == level) ? 1 : 0;
-            if (!node->isLeaf) {
-                for (uint8_t i = 0; i < 8; ++i) {
-                    if (node->childMask & (1 << i)) {
-                        count += countRecursive(node->nodeData.internal.children[i].get());
-                    }
-                }
-            }
-            return count;
-        };
-
-    return countRecursive(root.get());
+    // Nothing below the requested level can match, so those subtrees are pruned
+    size_t count = 0;
+    traverse([&](const NodeVisit& visit) {
+        const OctreeNode& node = nodes[visit.nodeIndex];
+        if (node.level == level) {
+            count++;
+        }
+        return node.level < level;
+    });
+    return count;
 }
 
 void World::createTestScene() {
     std::cout << "World: Creating test scene..." << std::endl;
     
     // Create a ground plane
-    for (int x = -8; x <= 8; x++) {
-        for (int z = -8; z <= 8; z++) {
-            Voxel groundVoxel;
-            groundVoxel.type = 1;  // Solid voxel
-            groundVoxel.color = 0x808080FF;  // Gray
-            setVoxel(glm::ivec3(x, -2, z), groundVoxel);
-        }
-    }
+    Material ground;
+    ground.color = 0x808080FF;  // Gray
+    fillBox(glm::ivec3(-8, -2, -8), glm::ivec3(9, -1, 9), Voxel{materials.add(ground)});
 
     // Create some colorful columns
     const uint32_t colors[] = {
@@ -515,23 +2213,15 @@ void World::createTestScene() {
 
     for (int i = 0; i < 4; i++) {
         glm::ivec3 pos(-6 + i * 4, -1, -6 + i * 4);
-        for (int y = 0; y < 5; y++) {
-            Voxel voxel;
-            voxel.type = 1;
-            voxel.color = colors[i];
-            setVoxel(pos + glm::ivec3(0, y, 0), voxel);
-        }
+        Material column;
+        column.color = colors[i];
+        fillBox(pos, pos + glm::ivec3(1, 5, 1), Voxel{materials.add(column)});
     }
 
     // Create a small platform
-    for (int x = -2; x <= 2; x++) {
-        for (int z = -2; z <= 2; z++) {
-            Voxel platformVoxel;
-            platformVoxel.type = 1;
-            platformVoxel.color = 0xA0522DFF;  // Brown
-            setVoxel(glm::ivec3(x, 3, z), platformVoxel);
-        }
-    }
+    Material platform;
+    platform.color = 0xA0522DFF;  // Brown
+    fillBox(glm::ivec3(-2, 3, -2), glm::ivec3(3, 4, 3), Voxel{materials.add(platform)});
 
     std::cout << "World: Test scene created" << std::endl;
 }
@@ -602,7 +2292,7 @@ bool World::createComputePipeline() {
     VkPushConstantRange pushConstantRange{};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(glm::ivec3) + 3 * sizeof(uint32_t); // nodePosition, nodeSize, maxVertices, maxIndices
+    pushConstantRange.size = 2 * sizeof(uint32_t); // maxVertices, maxIndices
 
     // Create pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -647,6 +2337,19 @@ bool World::createComputePipeline() {
         return false;
     }
     
+    // The shader only meshes bricks, their size is a specialization constant
+    VkSpecializationMapEntry brickSizeEntry{};
+    brickSizeEntry.constantID = 0;
+    brickSizeEntry.offset = 0;
+    brickSizeEntry.size = sizeof(uint32_t);
+    const uint32_t brickSize = BRICK_SIZE;
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = 1;
+    specializationInfo.pMapEntries = &brickSizeEntry;
+    specializationInfo.dataSize = sizeof(brickSize);
+    specializationInfo.pData = &brickSize;
+
     // Create compute pipeline
     VkComputePipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -654,6 +2357,7 @@ bool World::createComputePipeline() {
     pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     pipelineInfo.stage.module = shaderModule;
     pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = &specializationInfo;
     pipelineInfo.layout = pipelineLayout;
     
     if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS) {
@@ -698,11 +2402,171 @@ uint32_t World::findComputeQueueFamily(VkPhysicalDevice physicalDevice) {
     throw std::runtime_error("Failed to find compute queue family");
 }
 
-bool World::generateMeshForNode(OctreeNode* node) {
-    if (!node || !node->needsUpdate) return false;
+bool World::setMeshBackend(MeshBackend backend) {
+    if (backend == MeshBackend::Compute && renderer && computePipeline == VK_NULL_HANDLE) {
+        std::cerr << "World: Compute meshing is unavailable on this device" << std::endl;
+        return false;
+    }
+    meshBackend = backend;
+    brickMesher = createBrickMesher(backend);
+    restartMeshJobs();
+    return true;
+}
+
+void World::setMeshThreads(uint32_t count) {
+    meshThreads = count;
+    restartMeshJobs();
+}
+
+void World::restartMeshJobs() {
+    // Jobs in flight are no longer queued, let them land before the pool goes
+    if (meshJobs) {
+        meshJobs->waitIdle();
+        uploadFinishedMeshes();
+        meshJobs.reset();
+    }
+    if (brickMesher && meshThreads > 0) {
+        meshJobs = std::make_unique<MeshJobPool>(meshBackend, meshThreads);
+    }
+}
+
+void World::submitMeshJob(uint32_t nodeIndex) {
+    // One snapshot serves every job of a generateMeshes call. The brick's
+    // index stays valid in it, edits from now on copy the path instead.
+    if (!meshSnapshot) {
+        meshSnapshot = createSnapshot();
+    }
+    auto job = std::make_unique<MeshJob>();
+    job->nodeIndex = nodeIndex;
+    job->ticket = ++nextMeshTicket;
+    job->position = dirtyNodes.at(nodeIndex);
+    job->snapshot = meshSnapshot;
+    gatherApron(job->position, job->apron);
+    meshJobTickets[nodeIndex] = job->ticket;
+    meshJobs->submit(std::move(job));
+}
+
+void World::uploadFinishedMeshes() {
+    if (!meshJobs) return;
+    meshJobs->drain([this](MeshJob& job) {
+        auto ticket = meshJobTickets.find(job.nodeIndex);
+        if (ticket == meshJobTickets.end() || ticket->second != job.ticket) {
+            return;     // Edited or released since, a newer job or no mesh is wanted
+        }
+        meshJobTickets.erase(ticket);
+        if (!uploadMesh(job.nodeIndex, job.quads)) {
+            queueMesh(job.nodeIndex, job.position);
+        }
+    });
+
+    // Drained jobs may have dropped the last reference to their snapshot,
+    // releasing it now lets this frame's compaction and budget run
+    releaseRetiredSnapshots();
+}
+
+void World::decodeMeshVoxels(const OctreeNode& node, uint32_t size, MaterialId* out) const {
+    if (node.isLeaf() && !node.isUniform()) {
+        // Decoded bricks match the shader's x-fastest indexing
+        leafPayloads[node.payload].decode(out);
+    } else if (node.isLeaf() && size == BRICK_SIZE) {
+        // Collapsed brick, expand the uniform value
+        std::fill_n(out, BRICK_VOLUME, static_cast<MaterialId>(node.payload));
+    } else {
+        // Empty nodes are all air
+        std::fill_n(out, BRICK_VOLUME, MATERIAL_AIR);
+    }
+}
+
+void World::gatherApron(const glm::ivec3& position, BrickApron& apron) const {
+    // One neighbor lookup per face. Uniform leaves cover the whole face and
+    // bricks hand over the layer touching it; missing nodes and unloaded or
+    // compressed regions count as air, so the brick keeps its faces there,
+    // as do the borders of subtrees drawn at several positions.
+    constexpr uint64_t ROW = BRICK_SIZE == 64 ? ~uint64_t(0) : (uint64_t(1) << BRICK_SIZE) - 1;
+    NodeLocation location = locateNode(position, BRICK_LEVEL);
+    uint32_t openFaces = sharedBorderFaces(position, BRICK_LEVEL);
+    for (uint32_t face = 0; face < 6; ++face) {
+        glm::ivec3 direction(0);
+        direction[face >> 1] = (face & 1) ? 1 : -1;
+        uint32_t neighbor = (openFaces >> face) & 1 ? INVALID_INDEX : findNeighbor(location, direction).nodeIndex;
+        uint64_t* rows = apron.faceRows(face);
+        if (neighbor == INVALID_INDEX || !nodes[neighbor].anySolid()) {
+            std::fill_n(rows, BRICK_SIZE, 0);
+        } else if (nodes[neighbor].allSolid()) {
+            std::fill_n(rows, BRICK_SIZE, ROW);
+        } else {
+            // Partly solid leaves are always bricks
+            leafPayloads[nodes[neighbor].payload].getFaceOccupancy(face ^ 1, rows);
+        }
+    }
+}
+
+uint32_t World::sharedBorderFaces(const glm::ivec3& position, uint32_t level) const {
+    if (sharedGroups.empty()) return 0;
+
+    // The outermost shared group on the path decides, its parent's box is
+    // what gets drawn at several positions
+    glm::ivec3 coord = regionCoord(position);
+    uint32_t nodeIndex = regions.find(coord);
+    glm::ivec3 origin = regionOrigin(coord);
+    uint32_t size = REGION_SIZE;
+    for (uint32_t depth = 0; depth < level && nodeIndex != INVALID_INDEX; ++depth) {
+        const OctreeNode& node = nodes[nodeIndex];
+        if (node.isLeaf() || node.childBase == INVALID_INDEX) break;
+        if (sharedGroups.count(node.childBase)) {
+            glm::ivec3 lo = position - origin;
+            glm::ivec3 hi = lo + glm::ivec3(static_cast<int>(REGION_SIZE >> level));
+            uint32_t faces = 0;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (lo[axis] == 0) faces |= 1u << (axis * 2);
+                if (hi[axis] == static_cast<int>(size)) faces |= 1u << (axis * 2 + 1);
+            }
+            return faces;
+        }
+        size >>= 1;
+        uint32_t i = childIndex(position, size);
+        origin += childOffset(i, size);
+        nodeIndex = node.child(i);
+    }
+    return 0;
+}
+
+bool World::generateMeshForNode(uint32_t nodeIndex, uint32_t size) {
+    if (nodeIndex == INVALID_INDEX || dirtyNodes.count(nodeIndex) == 0) return false;
+    const OctreeNode& node = nodes[nodeIndex];
+
+    if (node.isLeaf() && node.isUniform() && size > BRICK_SIZE) {
+        // Collapsed region larger than a brick, its surface is the node's
+        // box. Mesh units scale with the node, so every box spans a brick.
+        meshQuads.clear();
+        if (isSolidVoxel(node.payload)) {
+            appendBoxQuads(BRICK_SIZE, static_cast<MaterialId>(node.payload), meshQuads);
+        }
+        return uploadMesh(nodeIndex, meshQuads);
+    }
+
+    // Empty bricks and solid ones buried behind solid neighbors have no
+    // visible faces, skip the upload and dispatch
+    if (!node.anySolid() || (node.allSolid() && isEnclosed(nodeIndex, dirtyNodes.at(nodeIndex)))) {
+        return createMeshBuffers(nodeIndex, {}, {});
+    }
+
+    // Only bricks get this far
+    if (brickMesher) {
+        if (meshJobs) {
+            submitMeshJob(nodeIndex);
+            return true;
+        }
+        meshVoxels.resize(BRICK_VOLUME);
+        decodeMeshVoxels(node, size, meshVoxels.data());
+        gatherApron(dirtyNodes.at(nodeIndex), meshApron);
+        meshQuads.clear();
+        brickMesher->meshBrick(meshVoxels.data(), meshApron, meshQuads);
+        return uploadMesh(nodeIndex, meshQuads);
+    }
 
-    // Create buffers for voxel data
-    const uint32_t voxelBufferSize = node->size * node->size * node->size * sizeof(uint32_t);
+    // Material ids, two per 32-bit word on the shader side, then the apron
+    const uint32_t voxelBufferSize = BRICK_VOLUME * sizeof(MaterialId) + sizeof(BrickApron::rows);
     VkBuffer voxelBuffer;
     VkDeviceMemory voxelMemory;
 
@@ -728,18 +2592,11 @@ bool World::generateMeshForNode(OctreeNode* node) {
     // Map and fill staging buffer with voxel data
     void* data;
     vkMapMemory(device, stagingMemory, 0, voxelBufferSize, 0, &data);
-    uint32_t* voxelData = static_cast<uint32_t*>(data);
-
-    // Fill voxel data from node
-    if (node->isLeaf && !node->nodeData.leaf.data.empty()) {
-        // For leaf nodes, copy the voxel data directly
-        std::memcpy(voxelData, node->nodeData.leaf.data.data(), 
-                   node->nodeData.leaf.data.size() * sizeof(uint32_t));
-    } else {
-        // For internal nodes or empty nodes, fill with air voxels
-        std::memset(voxelData, 0, voxelBufferSize);
-    }
+    MaterialId* voxelData = static_cast<MaterialId*>(data);
 
+    decodeMeshVoxels(node, size, voxelData);
+    gatherApron(dirtyNodes.at(nodeIndex), meshApron);
+    std::memcpy(voxelData + BRICK_VOLUME, meshApron.rows.data(), sizeof(meshApron.rows));
     vkUnmapMemory(device, stagingMemory);
 
     // Copy staging buffer to device local buffer
@@ -750,15 +2607,15 @@ bool World::generateMeshForNode(OctreeNode* node) {
     vkFreeMemory(device, stagingMemory, nullptr);
 
     // Create output mesh buffers
-    const uint32_t maxVertices = node->size * node->size * node->size * 24; // 24 vertices per voxel (worst case)
-    const uint32_t maxIndices = node->size * node->size * node->size * 36;  // 36 indices per voxel (worst case)
+    const uint32_t maxVertices = size * size * size * 24; // 24 vertices per voxel (worst case)
+    const uint32_t maxIndices = size * size * size * 36;  // 36 indices per voxel (worst case)
     const uint32_t meshBufferSize = 
-        maxVertices * (8 * sizeof(float)) + // pos(3) + normal(3) + uv(2)
+        maxVertices * sizeof(MeshVertex) +  // packed vertices
         maxIndices * sizeof(uint32_t) +     // indices
         2 * sizeof(uint32_t);               // vertex and index counts
 
     // Create vertex buffer
-    const uint32_t vertexBufferSize = maxVertices * 8 * sizeof(float); // 8 floats per vertex
+    const uint32_t vertexBufferSize = maxVertices * sizeof(MeshVertex);
     VkBuffer vertexBuffer;
     VkDeviceMemory vertexMemory;
     if (!createBuffer(vertexBufferSize,
@@ -919,22 +2776,18 @@ bool World::generateMeshForNode(OctreeNode* node) {
 
     // Push constants
     struct PushConstants {
-        glm::ivec3 nodePosition;
-        uint32_t nodeSize;
         uint32_t maxVertices;
         uint32_t maxIndices;
     } pushConstants;
 
-    pushConstants.nodePosition = node->position;
-    pushConstants.nodeSize = node->size;
     pushConstants.maxVertices = maxVertices;
     pushConstants.maxIndices = maxIndices;
 
     vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
 
     // Dispatch compute shader
-    const uint32_t workGroupSize = 8;
-    uint32_t groupCount = (node->size + workGroupSize - 1) / workGroupSize;
+    constexpr uint32_t workGroupSize = 8;
+    constexpr uint32_t groupCount = (BRICK_SIZE + workGroupSize - 1) / workGroupSize;
     vkCmdDispatch(commandBuffer, groupCount, groupCount, groupCount);
 
     // Memory barrier to ensure compute shader writes are visible
@@ -984,11 +2837,9 @@ bool World::generateMeshForNode(OctreeNode* node) {
     vkDestroyBuffer(device, counterBuffer, nullptr);
     vkFreeMemory(device, counterMemory, nullptr);
 
-    // Store mesh data in node
-    auto& meshData = meshes[node];
-    if (meshData.vertexBuffer != VK_NULL_HANDLE) {
-        cleanupMeshData(meshData);
-    }
+    // Store mesh data in the side table
+    auto& meshData = meshes[nodeIndex];
+    cleanupMeshData(meshData);
 
     meshData.vertexBuffer = vertexBuffer;
     meshData.vertexMemory = vertexMemory;
@@ -996,10 +2847,10 @@ bool World::generateMeshForNode(OctreeNode* node) {
     meshData.indexMemory = indexMemory;
     meshData.vertexCount = vertexCount;
     meshData.indexCount = indexCount;
-
-    // Update node's mesh vector
-    node->meshes.clear();
-    node->meshes.push_back(meshData);
+    meshData.indexType = VK_INDEX_TYPE_UINT32;
+    meshData.memorySize = VkDeviceSize(vertexBufferSize) + indexBufferSize;
+    stats.meshBytes += meshData.memorySize;
+    stats.meshCount++;
 
     std::cout << "World: Generated mesh for node with " << vertexCount << " vertices and "
               << indexCount << " indices" << std::endl;
@@ -1011,40 +2862,231 @@ bool World::generateMeshForNode(OctreeNode* node) {
     return true;
 }
 
+bool World::uploadMesh(uint32_t nodeIndex, const std::vector<MeshQuad>& quads) {
+    if (meshFormat == MeshFormat::FaceList) {
+        return createQuadMesh(nodeIndex, quads);
+    }
+    meshVertices.clear();
+    meshIndices.clear();
+    for (const MeshQuad& quad : quads) {
+        appendQuadVertices(quad, meshVertices, meshIndices);
+    }
+    return createMeshBuffers(nodeIndex, meshVertices, meshIndices);
+}
+
+bool World::createMeshBuffers(uint32_t nodeIndex, const std::vector<MeshVertex>& vertices,
+                              const std::vector<uint32_t>& indices) {
+    releaseMesh(nodeIndex);
+    if (indices.empty()) return true;
+
+    // CPU-built meshes are small, host visible memory avoids a staging copy
+    // and indices drop to 16 bits whenever every vertex is reachable with them
+    MeshData meshData;
+    const bool shortIndices = vertices.size() <= 0x10000;
+    meshData.indexType = shortIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    VkDeviceSize vertexSize = vertices.size() * sizeof(MeshVertex);
+    VkDeviceSize indexSize = indices.size() * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+    if (!createBuffer(vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        meshData.vertexBuffer, meshData.vertexMemory)) {
+        return false;
+    }
+    if (!createBuffer(indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        meshData.indexBuffer, meshData.indexMemory)) {
+        cleanupMeshData(meshData);
+        return false;
+    }
+
+    void* data;
+    vkMapMemory(device, meshData.vertexMemory, 0, vertexSize, 0, &data);
+    std::memcpy(data, vertices.data(), vertexSize);
+    vkUnmapMemory(device, meshData.vertexMemory);
+
+    vkMapMemory(device, meshData.indexMemory, 0, indexSize, 0, &data);
+    if (shortIndices) {
+        uint16_t* shortData = static_cast<uint16_t*>(data);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            shortData[i] = static_cast<uint16_t>(indices[i]);
+        }
+    } else {
+        std::memcpy(data, indices.data(), indexSize);
+    }
+    vkUnmapMemory(device, meshData.indexMemory);
+
+    meshData.vertexCount = static_cast<uint32_t>(vertices.size());
+    meshData.indexCount = static_cast<uint32_t>(indices.size());
+    meshData.memorySize = vertexSize + indexSize;
+    stats.meshBytes += meshData.memorySize;
+    stats.meshCount++;
+    meshes[nodeIndex] = meshData;
+    return true;
+}
+
+bool World::createQuadMesh(uint32_t nodeIndex, const std::vector<MeshQuad>& quads) {
+    releaseMesh(nodeIndex);
+    if (quads.empty()) return true;
+
+    const uint32_t count = static_cast<uint32_t>(quads.size());
+    uint32_t first = quadRanges.allocate(count);
+    if (first == INVALID_INDEX) {
+        // The grown tail alone fits the mesh, however fragmented the rest is
+        if (!growQuadBuffer(quadRanges.getCapacity() + count)) {
+            return false;
+        }
+        first = quadRanges.allocate(count);
+    }
+    std::memcpy(quadData + first, quads.data(), count * sizeof(MeshQuad));
+
+    MeshData meshData;
+    meshData.firstQuad = first;
+    meshData.quadCount = count;
+    meshData.memorySize = count * sizeof(MeshQuad);
+    stats.meshBytes += meshData.memorySize;
+    stats.meshCount++;
+    meshes[nodeIndex] = meshData;
+    return true;
+}
+
+bool World::growQuadBuffer(uint32_t minCapacity) {
+    uint32_t capacity = std::max({MIN_QUAD_CAPACITY, quadRanges.getCapacity() * 2, minCapacity});
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    if (!createBuffer(VkDeviceSize(capacity) * sizeof(MeshQuad), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        buffer, memory)) {
+        std::cerr << "World: Failed to grow quad buffer to " << capacity << " quads" << std::endl;
+        return false;
+    }
+    void* data;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+
+    if (quadData) {
+        // Frames in flight still draw from the old buffer. Growth doubles,
+        // so this stall is rare.
+        vkDeviceWaitIdle(device);
+        std::memcpy(data, quadData, size_t(quadRanges.getCapacity()) * sizeof(MeshQuad));
+        vkUnmapMemory(device, quadMemory);
+        vkDestroyBuffer(device, quadBuffer, nullptr);
+        vkFreeMemory(device, quadMemory, nullptr);
+    }
+    quadBuffer = buffer;
+    quadMemory = memory;
+    quadData = static_cast<MeshQuad*>(data);
+    quadRanges.grow(capacity);
+    std::cout << "World: Quad buffer holds " << capacity << " quads" << std::endl;
+    return true;
+}
+
+void World::cleanupQuadBuffer() {
+    if (quadData) {
+        vkUnmapMemory(device, quadMemory);
+        vkDestroyBuffer(device, quadBuffer, nullptr);
+        vkFreeMemory(device, quadMemory, nullptr);
+        quadBuffer = VK_NULL_HANDLE;
+        quadMemory = VK_NULL_HANDLE;
+        quadData = nullptr;
+    }
+    quadRanges.clear();
+}
+
+void World::releaseRetiredMeshes() {
+    // The next list in the ring is the oldest one, every frame that could
+    // draw its meshes has finished by now
+    auto& retired = retiredMeshes[(accessFrame + 1) % retiredMeshes.size()];
+    for (const MeshData& meshData : retired) {
+        destroyMeshData(meshData);
+    }
+    retired.clear();
+}
+
+void World::moveMesh(uint32_t from, uint32_t to, const glm::ivec3& position) {
+    // The target holds the same voxels, it takes over the mesh and any pending rebuild
+    auto mesh = meshes.find(from);
+    if (mesh != meshes.end()) {
+        meshes[to] = mesh->second;
+        meshes.erase(mesh);
+    }
+    if (dirtyNodes.erase(from) + meshJobTickets.erase(from) > 0) {
+        queueMesh(to, position);
+    }
+}
+
+void World::releaseMesh(uint32_t nodeIndex) {
+    meshJobTickets.erase(nodeIndex);
+    auto mesh = meshes.find(nodeIndex);
+    if (mesh != meshes.end()) {
+        cleanupMeshData(mesh->second);
+        meshes.erase(mesh);
+    }
+}
+
 void World::cleanupMeshData(MeshData& meshData) {
+    if (meshData.vertexBuffer != VK_NULL_HANDLE || meshData.vertexMemory != VK_NULL_HANDLE ||
+        meshData.indexBuffer != VK_NULL_HANDLE || meshData.indexMemory != VK_NULL_HANDLE ||
+        meshData.quadCount != 0) {
+        retiredMeshes[accessFrame % retiredMeshes.size()].push_back(meshData);
+    }
+    meshData.vertexBuffer = VK_NULL_HANDLE;
+    meshData.vertexMemory = VK_NULL_HANDLE;
+    meshData.indexBuffer = VK_NULL_HANDLE;
+    meshData.indexMemory = VK_NULL_HANDLE;
+    meshData.quadCount = 0;
+    meshData.vertexCount = 0;
+    meshData.indexCount = 0;
+    meshData.indexType = VK_INDEX_TYPE_UINT32;
+    if (meshData.memorySize != 0) {
+        stats.meshBytes -= meshData.memorySize;
+        stats.meshCount--;
+        meshData.memorySize = 0;
+    }
+}
+
+void World::destroyMeshData(const MeshData& meshData) {
     if (meshData.vertexBuffer != VK_NULL_HANDLE) {
         vkDestroyBuffer(device, meshData.vertexBuffer, nullptr);
-        meshData.vertexBuffer = VK_NULL_HANDLE;
     }
     if (meshData.vertexMemory != VK_NULL_HANDLE) {
         vkFreeMemory(device, meshData.vertexMemory, nullptr);
-        meshData.vertexMemory = VK_NULL_HANDLE;
     }
     if (meshData.indexBuffer != VK_NULL_HANDLE) {
         vkDestroyBuffer(device, meshData.indexBuffer, nullptr);
-        meshData.indexBuffer = VK_NULL_HANDLE;
     }
     if (meshData.indexMemory != VK_NULL_HANDLE) {
         vkFreeMemory(device, meshData.indexMemory, nullptr);
-        meshData.indexMemory = VK_NULL_HANDLE;
     }
-    meshData.vertexCount = 0;
-    meshData.indexCount = 0;
+    if (meshData.quadCount != 0) {
+        quadRanges.release(meshData.firstQuad, meshData.quadCount);
+    }
 }
 
 void World::update() {
+    releaseRetiredSnapshots();
+    releaseRetiredMeshes();
+
     // Update LOD based on camera position
     if (renderer) {
         const Camera* camera = renderer->getCamera();
         if (camera) {
             glm::vec3 viewerPos = camera->getPosition();
+            keepViewResident(viewerPos);
             updateLOD(viewerPos);
             generateMeshes(viewerPos);
         }
     }
 
-    // Optimize nodes if needed
-    optimizeNodes();
+    // Collapse subtrees that recent edits made uniform
+    collapseDirtyPaths();
+
+    // Compress whatever went cold while the world is over budget
+    enforceMemoryBudget();
+
+    // Re-merge subtrees duplicated by edits, a slice per frame
+    if (deduplicate) {
+        compactStep(COMPACTION_BUDGET);
+    }
+
+    accessFrame++;
 }
 
 bool World::createBuffer(uint64_t size, uint32_t usage, uint32_t properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
@@ -1,11 +1,21 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
 #include <unordered_map>
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 #include "VoxelTypes.h"
+#include "PaletteBrick.h"
+#include "MaterialRegistry.h"
+#include "MeshTypes.h"
+#include "BrickMesher.h"
+#include "OctreeTraversal.h"
+#include "RegionMap.h"
+#include "RangeAllocator.h"
 #include "../vulkan/core/Vertex.h"
 
 namespace voxceleron {
@@ -13,9 +23,78 @@ namespace voxceleron {
 class Camera;
 class WorldRenderer;
 class VulkanContext;
+class WorldSnapshot;
+class MeshJobPool;
 
-// Maximum level of detail for the octree
-static constexpr uint32_t MAX_LEVEL = 16;
+// The world is an unbounded grid of regions, each an octree spanning
+// REGION_SIZE voxels per axis
+static constexpr uint32_t REGION_SIZE_LOG2 = 10;
+static constexpr uint32_t REGION_SIZE = 1u << REGION_SIZE_LOG2;
+
+// Maximum level of detail for a region octree, the root is level 0
+static constexpr uint32_t MAX_LEVEL = REGION_SIZE_LOG2;
+
+// Octree level at which nodes become dense voxel bricks (see VoxelTypes.h)
+static constexpr uint32_t BRICK_LEVEL = MAX_LEVEL - BRICK_SIZE_LOG2;
+
+// Storage for non-uniform leaf bricks. A block holds 2^22 voxels worth of
+// bricks whatever the brick size, 1024 of them at 16^3.
+static constexpr uint32_t PAYLOAD_BLOCK_SHIFT = 22 - 3 * BRICK_SIZE_LOG2;
+using LeafPayloadPool = SlabAllocator<PaletteBrick, PAYLOAD_BLOCK_SHIFT, 1024>;
+
+// Octree and memory counters. World keeps them current as nodes, bricks and
+// meshes come and go, so a snapshot costs O(1).
+struct WorldStats {
+    std::array<uint32_t, MAX_LEVEL + 1> nodesPerLevel{};
+    uint32_t leafNodes = 0;
+    uint32_t internalNodes = 0;
+    uint32_t meshCount = 0;
+    size_t nodeBytes = 0;       // Node pool storage
+    size_t payloadBytes = 0;    // Palette bricks and their reference counts
+    size_t meshBytes = 0;       // GPU vertex and index buffers
+
+    // Cold region compression
+    size_t residentBytes = 0;       // Live nodes and bricks, what the memory budget limits
+    uint32_t compressedRegions = 0;
+    size_t compressedBytes = 0;     // Compressed streams as stored
+    size_t uncompressedBytes = 0;   // The same streams before compression
+    uint32_t restoredRegions = 0;
+    double restoreMicros = 0.0;     // Total time spent restoring regions
+
+    float compressionRatio() const {
+        return compressedBytes != 0 ? static_cast<float>(uncompressedBytes) / compressedBytes : 0.0f;
+    }
+    double averageRestoreMicros() const {
+        return restoredRegions != 0 ? restoreMicros / restoredRegions : 0.0;
+    }
+};
+
+// A cold region's octree, serialized in pre-order and LZ-compressed.
+// Immutable once built, so snapshots can keep it after the world moves on.
+struct CompressedRegion {
+    std::vector<uint8_t> data;
+    size_t rawSize = 0;
+};
+
+// A cell of the octree at some level and the nodes leading to it, as the
+// neighbor queries take and return it. The code is the Morton code of the
+// cell's origin within its region, so cells below a common ancestor at
+// level L agree in their top 3 * L bits and the octant at each level is
+// three bits of the code.
+struct NodeLocation {
+    glm::ivec3 region{0};
+    uint32_t code = 0;
+    uint32_t level = 0;
+    uint32_t nodeIndex = INVALID_INDEX;     // The cell's node, or a leaf above covering it; INVALID_INDEX for air
+    uint32_t depth = 0;                     // Valid path entries, the last is nodeIndex or a node missing the next child
+    std::array<uint32_t, MAX_LEVEL + 1> path;
+
+    glm::ivec3 position() const {
+        return region * static_cast<int>(REGION_SIZE) +
+               glm::ivec3(compactBits3(code), compactBits3(code >> 1), compactBits3(code >> 2));
+    }
+    uint32_t size() const { return REGION_SIZE >> level; }
+};
 
 // LOD constants
 struct LODParameters {
@@ -27,29 +106,114 @@ struct LODParameters {
 
 class World {
 public:
+    // Without a context the world is headless: voxels can be stored and
+    // edited, but initialize() and everything GPU-side are unavailable
     World(VulkanContext* context);
     ~World();
     
+    // Materials voxels can reference, register them before use
+    MaterialRegistry& getMaterials() { return materials; }
+    const MaterialRegistry& getMaterials() const { return materials; }
+
     // Core world manipulation
     void setVoxel(const glm::ivec3& pos, const Voxel& voxel);
-    Voxel getVoxel(const glm::ivec3& pos) const;
-    
+    Voxel getVoxel(const glm::ivec3& pos);  // Restores the region if it was compressed
+
+    // Bulk edits. Each affected node is visited once, and nodes covered
+    // entirely by a fill collapse into a single uniform leaf. Boxes are
+    // half-open, [min, max).
+    void fillBox(const glm::ivec3& min, const glm::ivec3& max, const Voxel& voxel);
+    void fillSphere(const glm::vec3& center, float radius, const Voxel& voxel);
+    void setVoxels(const VoxelEdit* edits, size_t count);
+    void copyRegion(const glm::ivec3& srcMin, const glm::ivec3& srcMax, const glm::ivec3& dstMin);
+
+    // Dense copies of the box [min, max) to and from a caller buffer, where
+    // voxel min + (x, y, z) lives at x + y * rowStride + z * sliceStride.
+    // Zero strides pack the box tightly. Both walk the octree once: uniform
+    // nodes become row fills and bricks copy whole rows. Extracting restores
+    // compressed regions, like getVoxel.
+    void extractRegion(const glm::ivec3& min, const glm::ivec3& max, MaterialId* dst,
+                       size_t rowStride = 0, size_t sliceStride = 0);
+    void writeRegion(const glm::ivec3& min, const glm::ivec3& max, const MaterialId* src,
+                     size_t rowStride = 0, size_t sliceStride = 0);
+
+    // Summary queries over the box [min, max). Nodes inside the box answer
+    // from their summaries without being descended, so the cost follows the
+    // box's surface rather than its volume. The histogram counts air too,
+    // its counts add up to the box volume. Like extractRegion these restore
+    // compressed regions.
+    uint64_t countSolid(const glm::ivec3& min, const glm::ivec3& max);
+    bool isEmpty(const glm::ivec3& min, const glm::ivec3& max);
+    std::unordered_map<MaterialId, uint64_t> materialHistogram(const glm::ivec3& min, const glm::ivec3& max);
+
     // LOD and mesh generation
     void updateLOD(const glm::vec3& viewerPos);
     void generateMeshes(const glm::vec3& viewerPos);
-    bool generateMeshForNode(OctreeNode* node);
+    bool generateMeshForNode(uint32_t nodeIndex, uint32_t size);
+
+    // Where brick meshes are built, Compute unless set or the compute
+    // pipeline could not be created. Existing meshes stay until their nodes
+    // are remeshed. Fails for Compute once initialize() found it unavailable.
+    bool setMeshBackend(MeshBackend backend);
+    MeshBackend getMeshBackend() const { return meshBackend; }
+
+    // Worker threads building meshes for the CPU backends; 0 meshes on the
+    // editing thread inside generateMeshes. Defaults to one less than the
+    // hardware threads. Workers read bricks from a snapshot and the editing
+    // thread only uploads what they finish.
+    void setMeshThreads(uint32_t count);
+    uint32_t getMeshThreads() const { return meshThreads; }
+
+    // How meshes built on the CPU are uploaded, Indexed unless set. The
+    // renderer draws each mesh in the format it was built with, so switching
+    // only affects meshes built from now on. The compute backend always
+    // builds indexed meshes.
+    void setMeshFormat(MeshFormat format) { meshFormat = format; }
+    MeshFormat getMeshFormat() const { return meshFormat; }
+
+    // Storage buffer holding every face-list mesh's quads, at MeshData's
+    // firstQuad. The handle changes when the buffer grows; null until the
+    // first face-list mesh.
+    VkBuffer getQuadBuffer() const { return quadBuffer; }
     
-    // Node management
+    // Node management. optimizeNode collapses a node whose voxels all share
+    // one value into a uniform leaf; optimizeNodes runs it over the whole tree.
+    // Positions are the node's world-space origin, used to queue remeshing.
     bool optimizeNodes();
-    void subdivideNode(OctreeNode* node);
-    void optimizeNode(OctreeNode* node);
+    void subdivideNode(uint32_t nodeIndex, const glm::ivec3& position);
+    bool optimizeNode(uint32_t nodeIndex, const glm::ivec3& position);
+    size_t getPendingMeshCount() const { return dirtyNodes.size() + meshJobTickets.size(); }
     
     // Statistics and memory
     size_t getMemoryUsage() const;
     uint32_t getNodeCount() const;
     size_t calculateMemoryUsage() const;
-    size_t countNodes(bool activeOnly = false) const;
+    size_t countNodes() const;
     size_t countNodesByLevel(uint32_t level) const;
+    WorldStats getStats() const;
+#ifndef NDEBUG
+    // Recount everything and check it against getStats(). Walks the whole
+    // world, meant for tests and debugging rather than every frame.
+    bool validateStats() const;
+#endif
+
+    // Back node and payload storage with huge pages, must be called before initialize()
+    bool setHugePages(bool enabled);
+
+    // DAG mode: identical subtrees and bricks share storage. Edits copy
+    // shared paths on write and update() re-merges duplicates incrementally.
+    void setDeduplication(bool enabled);
+    bool isDeduplicationEnabled() const { return deduplicate; }
+    void compact();                        // Run a full deduplication pass now
+    bool compactStep(uint32_t groupBudget); // Advance the pass, true once it completes
+
+    // Consistent read-only copy of the world for other threads, sharing all
+    // storage with it. Must be taken on the editing thread and must not
+    // outlive the world; dropping the last reference is safe from any thread,
+    // the storage is handed back on the next update(). Deduplication passes
+    // wait while snapshots are alive.
+    std::shared_ptr<const WorldSnapshot> createSnapshot();
+    uint32_t getSnapshotCount() const { return liveSnapshots; }
     
     // Vulkan initialization
     bool initialize();
@@ -70,25 +234,238 @@ public:
     void setLODParameters(const LODParameters& params) { lodParams = params; }
     const LODParameters& getLODParameters() const { return lodParams; }
 
-    // Getters
-    const OctreeNode* getRoot() const { return root.get(); }
-    OctreeNode* getRoot() { return root.get(); }
+    // Regions are created on first write and can be released one at a
+    // time. A region's root spans [origin, origin + REGION_SIZE).
+    static glm::ivec3 regionCoord(const glm::ivec3& pos) {
+        return glm::ivec3(pos.x >> REGION_SIZE_LOG2, pos.y >> REGION_SIZE_LOG2, pos.z >> REGION_SIZE_LOG2);
+    }
+    static glm::ivec3 regionOrigin(const glm::ivec3& regionCoord) { return regionCoord * static_cast<int>(REGION_SIZE); }
+    uint32_t getRegionRoot(const glm::ivec3& regionCoord) const { return regions.find(regionCoord); }
+    size_t getRegionCount() const { return regions.size(); }
+    bool releaseRegion(const glm::ivec3& regionCoord);
+
+    // Budget for resident octree data in bytes, 0 for none. While it is
+    // exceeded update() compresses the regions accessed least recently,
+    // never those near the viewer or drawn last frame; editing or reading
+    // one, or the viewer coming near, restores it.
+    void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+    size_t getMemoryBudget() const { return memoryBudget; }
+    bool compressRegion(const glm::ivec3& regionCoord);
+
+    // Stamp a resident region as accessed this frame without restoring a
+    // compressed one. The renderer marks every region it draws.
+    void markRegionViewed(const glm::ivec3& regionCoord) { regions.touch(regionCoord, accessFrame); }
+
+    // Octree access. Nodes are addressed by pool index and child positions
+    // follow from childOffset.
+    const OctreeNode& getNode(uint32_t index) const { return nodes[index]; }
+
+    // Neighbor queries. locateNode descends from the root once; a neighbor
+    // walks up the given location's path to the common ancestor, found from
+    // the highest differing Morton bit, and back down, so nearby cells cost
+    // a few node reads. Directions have components in {-1, 0, 1}, faces,
+    // edges and corners alike. findNeighbors returns all 26 at once, moving
+    // along each axis only once and descending from the cell's path; they
+    // come in z, y, x order from (-1, -1, -1). Regions that are
+    // not resident read as air. Like node indices, locations are only valid
+    // until the next edit.
+    NodeLocation locateNode(const glm::ivec3& pos, uint32_t level) const;
+    NodeLocation findNeighbor(const NodeLocation& location, const glm::ivec3& direction) const;
+    void findNeighbors(const NodeLocation& location, std::array<NodeLocation, 26>& neighbors) const;
+    const MeshData* getMesh(uint32_t nodeIndex) const;
+    static glm::ivec3 childOffset(uint32_t childIndex, uint32_t childSize);
+
+    // Depth-first walk of every region, see traverseOctree for the callback
+    // contract. Callbacks must not create or release regions.
+    template<typename Pre, typename Post = NoPostVisit>
+    void traverse(Pre&& pre, Post&& post = Post(), uint32_t childOrder = 0) const {
+        regions.forEach([&](const glm::ivec3& coord, uint32_t rootIndex) {
+            traverseOctree<MAX_LEVEL + 1>(nodes, NodeVisit{rootIndex, regionOrigin(coord), REGION_SIZE},
+                                          pre, post, childOrder);
+        });
+    }
     
 private:
+    friend class VoxelAccessor;
+
     // Octree management
-    std::unique_ptr<OctreeNode> root;
-    const OctreeNode* findNode(const glm::ivec3& pos) const;
-    OctreeNode* findNode(const glm::ivec3& pos, bool create = false);
+    NodePool nodes;
+    RegionMap regions;
+    uint32_t findNode(const glm::ivec3& pos, bool create, uint32_t* path = nullptr, uint32_t startLevel = 0);
+    static uint32_t childIndex(const glm::ivec3& pos, uint32_t childSize);
+    uint32_t createRegion(const glm::ivec3& regionCoord);
+    void createChildren(uint32_t nodeIndex);
+    void releaseChildren(uint32_t nodeIndex);
+    void releaseGroup(uint32_t childBase);
+    void makeChildrenUnique(uint32_t nodeIndex, const glm::ivec3& position);
+    uint32_t addChild(uint32_t nodeIndex, uint32_t childIndex);
+    void setUniform(uint32_t nodeIndex, const glm::ivec3& position, uint32_t packedVoxel);
+
+    // Node summaries: occupancy flags, solid count and material range.
+    // Leaves derive theirs from their value or brick, internal nodes from
+    // their children, so edits refresh them bottom-up.
+    struct NodeSummary {
+        uint8_t flags;
+        uint32_t solidCount;
+        MaterialId minMaterial;
+        MaterialId maxMaterial;
+    };
+    NodeSummary summarize(uint32_t nodeIndex) const;
+    bool updateSummary(uint32_t nodeIndex);     // False if nothing changed
+    uint32_t solidCount(uint32_t nodeIndex) const;
+    bool isEnclosed(uint32_t nodeIndex, const glm::ivec3& position) const;
+    PaletteBrick& writableBrick(uint32_t nodeIndex);
+
+    // Neighbor query steps: the deepest path entry of known also above the
+    // cell of location (-1 if none), and the descent from that entry
+    static int sharedLevel(const NodeLocation& known, const NodeLocation& location);
+    void descendLocation(NodeLocation& location, int startLevel) const;
+
+    // Store one voxel in a brick leaf, path holds the unique nodes above it by level
+    void writeVoxel(uint32_t nodeIndex, const uint32_t* path, const glm::ivec3& pos, MaterialId material);
+
+    // Advanced whenever a node may stop being where a cached root-to-leaf
+    // path expects it: groups released or replaced, leaves split, children
+    // or regions added, paths shared with a snapshot
+    uint64_t topologyVersion;
+
+    // Paths touched by edits since the last collapse pass, keyed by node
+    // position and level so repeated edits to one node queue it once
+    struct CollapseCandidate {
+        glm::ivec3 position;
+        uint32_t level;
+        bool operator==(const CollapseCandidate& other) const {
+            return position == other.position && level == other.level;
+        }
+    };
+    struct CollapseCandidateHash {
+        size_t operator()(const CollapseCandidate& candidate) const {
+            return (static_cast<size_t>(candidate.position.x) * 73856093u) ^
+                   (static_cast<size_t>(candidate.position.y) * 19349663u) ^
+                   (static_cast<size_t>(candidate.position.z) * 83492791u) ^ candidate.level;
+        }
+    };
+    std::unordered_set<CollapseCandidate, CollapseCandidateHash> collapseCandidates;
+    void markCollapseCandidate(const glm::ivec3& position, uint32_t level);
+    bool collapseDirtyPaths();
+
+    // Bulk edit traversal
+    struct SortedEdit {
+        glm::ivec3 region;
+        uint64_t key;           // Morton code of the position within the region
+        glm::ivec3 position;
+        uint32_t packedVoxel;
+    };
+    template<typename Shape>
+    void fillShape(const Shape& shape, uint32_t packedVoxel);
+    template<typename Shape>
+    void fillNode(uint32_t nodeIndex, const glm::ivec3& position, uint32_t size,
+                  const Shape& shape, uint32_t packedVoxel);
+    void applyEdits(uint32_t nodeIndex, uint32_t size, const SortedEdit* begin, const SortedEdit* end);
+
+    // Source buffer of writeRegion with its strides resolved
+    struct DenseSource {
+        glm::ivec3 min;
+        glm::ivec3 max;
+        const MaterialId* data;
+        size_t rowStride;
+        size_t sliceStride;
+
+        const MaterialId* at(int x, int y, int z) const {
+            return data + (x - min.x) + (y - min.y) * rowStride + (z - min.z) * sliceStride;
+        }
+        bool isUniform(const glm::ivec3& lo, const glm::ivec3& hi, MaterialId& value) const;
+    };
+    void writeNode(uint32_t nodeIndex, const glm::ivec3& position, uint32_t size, const DenseSource& src);
+
+    // Top-down walk of the nodes overlapping [min, max) for the summary
+    // queries. visit(nodeIndex, position, size, lo, hi) gets INVALID_INDEX for space
+    // without nodes, which is air, and picks how the walk continues.
+    enum class BoxStep { Skip, Descend, Stop };
+    template<typename Visit>
+    void visitBox(const glm::ivec3& min, const glm::ivec3& max, Visit&& visit);
+
+    MaterialRegistry materials;
+
+    // Leaf payloads, referenced by OctreeNode::payload and shared in DAG mode
+    LeafPayloadPool leafPayloads;
+    std::vector<uint32_t> payloadRefs;
+    uint32_t allocateLeafPayload(uint32_t packedVoxel);
+    uint32_t copyLeafPayload(uint32_t payloadIndex);
+    void retainLeafPayload(uint32_t payloadIndex) { ++payloadRefs[payloadIndex]; }
+    void releaseLeafPayload(uint32_t payloadIndex);
+
+    // Incremental statistics. Node counts follow the tree as traversed, so
+    // subtrees shared in DAG mode count once per reference.
+    WorldStats stats;
+    size_t brickHeapBytes;      // Heap memory owned by live bricks
+    void countNode(uint32_t nodeIndex, int delta);
+    void countSubtree(uint32_t nodeIndex, int delta);
+
+    // DAG deduplication state. Canonical tables map content hashes to the
+    // first group or brick seen with that content during the current pass.
+    static constexpr uint32_t COMPACTION_BUDGET = 256;  // Groups merged per update()
+    struct CompactionFrame {
+        uint32_t nodeIndex;
+        glm::ivec3 position;
+        uint32_t nextChild;
+    };
+    bool deduplicate;
+    bool compactionPending;
+    bool compacting;
+    std::vector<CompactionFrame> compactionStack;
+    std::unordered_map<uint64_t, uint32_t> canonicalGroups;
+    std::unordered_map<uint64_t, uint32_t> canonicalBricks;
+    std::unordered_set<uint32_t> compactedGroups;
+
+    // Groups drawn through several parents, merge targets and the groups
+    // below them once a path through one is copied. Meshes are keyed by
+    // node, so bricks on the border of such a subtree cull nothing across
+    // it; their neighbors differ between placements.
+    std::unordered_set<uint32_t> sharedGroups;
+    uint32_t sharedBorderFaces(const glm::ivec3& position, uint32_t level) const;
+    uint32_t mergedGroups;
+    uint32_t mergedBricks;
+    void restartCompaction();
+    void scheduleCompaction();
+    void compactGroup(uint32_t nodeIndex, const glm::ivec3& position);
+    uint32_t canonicalBrick(uint32_t payloadIndex);
+    uint64_t hashGroup(uint32_t childBase) const;
+    bool groupsEqual(uint32_t a, uint32_t b) const;
+
+    // Cold regions. Each access stamps its region with accessFrame, which
+    // update() advances, so the stamps order regions by recency.
+    static constexpr int VIEW_REGION_RADIUS = 1;    // Regions around the viewer kept resident
+    size_t memoryBudget;
+    uint32_t accessFrame;
+    RegionMap compressedRegions;                    // Region coordinate to compressedStore slot
+    std::vector<std::shared_ptr<const CompressedRegion>> compressedStore;
+    std::vector<uint32_t> freeCompressedSlots;
+    uint32_t accessRegion(const glm::ivec3& regionCoord, bool create);
+    uint32_t restoreRegion(const glm::ivec3& regionCoord);
+    std::shared_ptr<const CompressedRegion> takeCompressedRegion(const glm::ivec3& regionCoord);
+    void dropResidentRegion(const glm::ivec3& regionCoord, uint32_t rootIndex);
+    void keepViewResident(const glm::vec3& viewerPos);
+    void enforceMemoryBudget();
+    size_t residentBytes() const;
+    size_t compressedIndexBytes() const;    // Lookup structures for the compressed store
+    void serializeNode(uint32_t nodeIndex, std::vector<uint8_t>& out) const;
+    const uint8_t* deserializeNode(uint32_t nodeIndex, const glm::ivec3& position, const uint8_t* in);
+
+    // Snapshots dropped by their readers, released on the editing thread
+    uint32_t liveSnapshots;
+    std::mutex retiredSnapshotsMutex;
+    std::vector<WorldSnapshot*> retiredSnapshots;
+    void releaseRetiredSnapshots();
 
     // Memory management
-    MemoryPool<OctreeNode> nodePool;
-    std::unordered_map<OctreeNode*, std::unique_ptr<MeshCacheEntry>> meshCache;
+    std::unordered_map<uint32_t, std::unique_ptr<MeshCacheEntry>> meshCache;
     void cleanupOldCacheEntries();
     
     // LOD management
     LODParameters lodParams;
     float calculateNodeLOD(const glm::vec3& nodePos, float nodeSize, const glm::vec3& viewerPos);
-    bool shouldGenerateMesh(OctreeNode* node, const glm::vec3& viewerPos);
+    bool shouldGenerateMesh(uint32_t nodeIndex, const glm::vec3& viewerPos);
     
     // Vulkan resources
     VulkanContext* context;
@@ -101,20 +478,56 @@ private:
     VkQueue computeQueue;
     VkCommandPool commandPool;
     
-    // Mesh data
-    struct MeshData {
-        VkBuffer vertexBuffer;
-        VkDeviceMemory vertexMemory;
-        VkBuffer indexBuffer;
-        VkDeviceMemory indexMemory;
-        uint32_t vertexCount;
-        uint32_t indexCount;
-    };
-    std::unordered_map<OctreeNode*, MeshData> meshes;
+    // Mesh data, side table keyed by node index
+    std::unordered_map<uint32_t, MeshData> meshes;
+
+    // Leaves waiting for a mesh, mapped to their position for distance
+    // ordering. Keyed by index so a leaf edited many times is queued once.
+    static constexpr uint32_t MESH_BUDGET = 64;  // Meshes generated per frame
+    std::unordered_map<uint32_t, glm::ivec3> dirtyNodes;
+    void queueMesh(uint32_t nodeIndex, const glm::ivec3& position);
+    void queueNeighborMeshes(const glm::ivec3& position, uint32_t size, uint32_t faces);
 
     // Mesh generation
-    void addCubeToMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const Voxel& voxel);
-    bool createMeshBuffers(OctreeNode* node, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    MeshBackend meshBackend;
+    std::unique_ptr<BrickMesher> brickMesher;   // Set for the CPU backends
+    std::vector<MaterialId> meshVoxels;         // Scratch for the CPU backends
+    BrickApron meshApron;
+    std::vector<MeshQuad> meshQuads;
+    std::vector<MeshVertex> meshVertices;
+    std::vector<uint32_t> meshIndices;
+
+    // Face-list quads of every mesh, suballocated from one persistently
+    // mapped buffer so drawing a mesh needs no binds of its own
+    static constexpr uint32_t MIN_QUAD_CAPACITY = 1 << 16;
+    MeshFormat meshFormat;
+    VkBuffer quadBuffer;
+    VkDeviceMemory quadMemory;
+    MeshQuad* quadData;
+    RangeAllocator quadRanges;
+    bool growQuadBuffer(uint32_t minCapacity);
+    void cleanupQuadBuffer();
+
+
+    // Bricks being meshed by workers. A node's ticket is dropped when it is
+    // queued again or released, so results of stale jobs are discarded.
+    static constexpr uint32_t MESH_JOBS_PER_THREAD = 16;   // In flight, the rest stays sorted by distance
+    uint32_t meshThreads;
+    std::unique_ptr<MeshJobPool> meshJobs;
+    std::shared_ptr<const WorldSnapshot> meshSnapshot;      // Shared by the jobs of one generateMeshes call
+    std::unordered_map<uint32_t, uint32_t> meshJobTickets;
+    uint32_t nextMeshTicket;
+    void restartMeshJobs();
+    void submitMeshJob(uint32_t nodeIndex);
+    void uploadFinishedMeshes();
+
+    void decodeMeshVoxels(const OctreeNode& node, uint32_t size, MaterialId* out) const;
+    void gatherApron(const glm::ivec3& position, BrickApron& apron) const;     // Of the brick at position
+    bool uploadMesh(uint32_t nodeIndex, const std::vector<MeshQuad>& quads);   // In the current format
+    bool createMeshBuffers(uint32_t nodeIndex, const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices);
+    bool createQuadMesh(uint32_t nodeIndex, const std::vector<MeshQuad>& quads);
+    void releaseMesh(uint32_t nodeIndex);
+    void moveMesh(uint32_t from, uint32_t to, const glm::ivec3& position);
 
     // Rendering
     std::unique_ptr<WorldRenderer> renderer;
@@ -126,7 +539,15 @@ private:
                      VkMemoryPropertyFlags properties, VkBuffer& buffer,
                      VkDeviceMemory& bufferMemory);
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-    void cleanupMeshData(MeshData& meshData);
+    void cleanupMeshData(MeshData& meshData);   // Parks the buffers and quad range until no frame can draw them
+    void destroyMeshData(const MeshData& meshData);
+
+    // Buffers and quad ranges of released meshes, frames still in flight
+    // may draw them. Each update() parks its releases in the list of its
+    // frame and frees the list from MESH_RETIRE_FRAMES updates ago.
+    static constexpr uint32_t MESH_RETIRE_FRAMES = 2;  // Pipeline::MAX_FRAMES_IN_FLIGHT
+    std::array<std::vector<MeshData>, MESH_RETIRE_FRAMES + 1> retiredMeshes;
+    void releaseRetiredMeshes();
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     uint32_t findComputeQueueFamily(VkPhysicalDevice physicalDevice);
 
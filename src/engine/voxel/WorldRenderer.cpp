@@ -15,8 +15,15 @@ WorldRenderer::WorldRenderer()
     , physicalDevice(VK_NULL_HANDLE)
     , debugVisualization(false)
     , currentCamera(nullptr)
+    , currentWorld(nullptr)
     , pipelineLayout(VK_NULL_HANDLE)
     , graphicsPipeline(VK_NULL_HANDLE)
+    , faceListPipelineLayout(VK_NULL_HANDLE)
+    , faceListPipeline(VK_NULL_HANDLE)
+    , quadSetLayout(VK_NULL_HANDLE)
+    , quadDescriptorPool(VK_NULL_HANDLE)
+    , quadSet(VK_NULL_HANDLE)
+    , boundQuadBuffer(VK_NULL_HANDLE)
     , viewProjection(1.0f)
     , cameraPosition(0.0f) {
     std::cout << "WorldRenderer: Creating world renderer instance" << std::endl;
@@ -66,9 +73,49 @@ bool WorldRenderer::initialize(VkDevice device, VkPhysicalDevice physicalDevice)
         return false;
     }
 
-    // Create graphics pipeline
+    // Vertex input state
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(MeshVertex);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    // Packed vertex, basic.vert unpacks position, normal and uv
+    std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions{};
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32_UINT;
+    attributeDescriptions[0].offset = 0;
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
     std::cout << "WorldRenderer: Creating graphics pipeline..." << std::endl;
-    VkShaderModule vertShaderModule = createShaderModule("shaders/basic.vert.spv");
+    if (!createMeshPipeline("shaders/basic.vert.spv", vertexInputInfo, pipelineLayout, graphicsPipeline)) {
+        return false;
+    }
+
+    std::cout << "WorldRenderer: Creating face-list pipeline..." << std::endl;
+    if (!createFaceListPipeline()) {
+        return false;
+    }
+
+    if (!createDebugResources()) {
+        std::cerr << "WorldRenderer: Failed to create debug resources" << std::endl;
+        return false;
+    }
+
+    std::cout << "WorldRenderer: Initialization complete" << std::endl;
+    return true;
+}
+
+bool WorldRenderer::createMeshPipeline(const std::string& vertexShader,
+                                       const VkPipelineVertexInputStateCreateInfo& vertexInput,
+                                       VkPipelineLayout layout, VkPipeline& pipeline) {
+    VkShaderModule vertShaderModule = createShaderModule(vertexShader);
     VkShaderModule fragShaderModule = createShaderModule("shaders/basic.frag.spv");
     
     if (!vertShaderModule || !fragShaderModule) {
@@ -87,36 +134,6 @@ bool WorldRenderer::initialize(VkDevice device, VkPhysicalDevice physicalDevice)
     shaderStages[1].module = fragShaderModule;
     shaderStages[1].pName = "main";
 
-    // Vertex input state
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(float) * 8; // pos(3) + normal(3) + uv(2)
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-    // Position
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = 0;
-    // Normal
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = sizeof(float) * 3;
-    // UV
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[2].offset = sizeof(float) * 6;
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
     // Input assembly
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -182,7 +199,7 @@ bool WorldRenderer::initialize(VkDevice device, VkPhysicalDevice physicalDevice)
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pVertexInputState = &vertexInput;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
@@ -190,12 +207,12 @@ bool WorldRenderer::initialize(VkDevice device, VkPhysicalDevice physicalDevice)
     pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.layout = layout;
     pipelineInfo.renderPass = context->getRenderPass();
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
         std::cerr << "WorldRenderer: Failed to create graphics pipeline" << std::endl;
         vkDestroyShaderModule(device, vertShaderModule, nullptr);
         vkDestroyShaderModule(device, fragShaderModule, nullptr);
@@ -206,13 +223,93 @@ bool WorldRenderer::initialize(VkDevice device, VkPhysicalDevice physicalDevice)
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
     vkDestroyShaderModule(device, fragShaderModule, nullptr);
 
-    if (!createDebugResources()) {
-        std::cerr << "WorldRenderer: Failed to create debug resources" << std::endl;
+    return true;
+}
+
+bool WorldRenderer::createFaceListPipeline() {
+    // The world's quad buffer, read by face.vert
+    VkDescriptorSetLayoutBinding quadBinding{};
+    quadBinding.binding = 0;
+    quadBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    quadBinding.descriptorCount = 1;
+    quadBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &quadBinding;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &quadSetLayout) != VK_SUCCESS) {
+        std::cerr << "WorldRenderer: Failed to create quad descriptor set layout" << std::endl;
         return false;
     }
 
-    std::cout << "WorldRenderer: Initialization complete" << std::endl;
-    return true;
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &quadDescriptorPool) != VK_SUCCESS) {
+        std::cerr << "WorldRenderer: Failed to create quad descriptor pool" << std::endl;
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = quadDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &quadSetLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &quadSet) != VK_SUCCESS) {
+        std::cerr << "WorldRenderer: Failed to allocate quad descriptor set" << std::endl;
+        return false;
+    }
+
+    // Quads are expanded in the world's frame, so the camera comes in with
+    // the node transform instead of through a uniform buffer
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(FaceListPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &quadSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &faceListPipelineLayout) != VK_SUCCESS) {
+        std::cerr << "WorldRenderer: Failed to create face-list pipeline layout" << std::endl;
+        return false;
+    }
+
+    // No vertex input, face.vert pulls everything by gl_VertexIndex
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    return createMeshPipeline("shaders/face.vert.spv", vertexInputInfo, faceListPipelineLayout, faceListPipeline);
+}
+
+void WorldRenderer::updateQuadSet(VkBuffer quadBuffer) {
+    if (quadBuffer == boundQuadBuffer || quadBuffer == VK_NULL_HANDLE) return;
+
+    // Only happens when the world grows the buffer, which waits for the
+    // device first, so no submitted frame still reads the set
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = quadBuffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = quadSet;
+    write.dstBinding = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.descriptorCount = 1;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    boundQuadBuffer = quadBuffer;
 }
 
 VkShaderModule WorldRenderer::createShaderModule(const std::string& filename) {
@@ -261,6 +358,24 @@ void WorldRenderer::cleanup() {
             vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
             pipelineLayout = VK_NULL_HANDLE;
         }
+        if (faceListPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, faceListPipeline, nullptr);
+            faceListPipeline = VK_NULL_HANDLE;
+        }
+        if (faceListPipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, faceListPipelineLayout, nullptr);
+            faceListPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (quadDescriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(device, quadDescriptorPool, nullptr);  // Frees quadSet
+            quadDescriptorPool = VK_NULL_HANDLE;
+            quadSet = VK_NULL_HANDLE;
+        }
+        if (quadSetLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(device, quadSetLayout, nullptr);
+            quadSetLayout = VK_NULL_HANDLE;
+        }
+        boundQuadBuffer = VK_NULL_HANDLE;
     }
 
     device = VK_NULL_HANDLE;
@@ -271,8 +386,10 @@ void WorldRenderer::cleanup() {
 void WorldRenderer::prepareFrame(const Camera& camera, World& world) {
     // Update camera data
     currentCamera = &camera;
+    currentWorld = &world;
     viewProjection = camera.getProjectionMatrix(camera.getFov()) * camera.getViewMatrix();
     cameraPosition = camera.getPosition();
+    updateQuadSet(world.getQuadBuffer());
 
     // Update visible nodes
     updateVisibleNodes(camera, world);
@@ -301,15 +418,25 @@ void WorldRenderer::recordCommands(VkCommandBuffer commandBuffer) {
 void WorldRenderer::updateVisibleNodes(const Camera& camera, World& world) {
     visibleNodes.clear();
 
-    if (!world.getRoot()) {
+    if (world.getRegionCount() == 0) {
         return;
     }
 
     // Get camera frustum for culling
     const auto& frustum = camera.getFrustum();
 
-    // Start with root node
-    frustumCullNode(world.getRoot(), frustum);
+    // Walk down from the root, culled subtrees are pruned
+    world.traverse([&](const NodeVisit& visit) {
+        return frustumCullNode(world, visit, frustum);
+    });
+
+    // Regions in view count as accessed, so the memory budget keeps them
+    // and their meshes resident. Every visible node lies in a visible root.
+    for (const RenderNode& node : visibleNodes) {
+        if (node.size == REGION_SIZE) {
+            world.markRegionViewed(World::regionCoord(node.position));
+        }
+    }
 
     // Sort nodes by priority
     std::sort(visibleNodes.begin(), visibleNodes.end(),
@@ -323,48 +450,45 @@ void WorldRenderer::updateVisibleNodes(const Camera& camera, World& world) {
     }
 }
 
-void WorldRenderer::frustumCullNode(const OctreeNode* node, const Camera::Frustum& frustum) {
-    if (!node) return;
+bool WorldRenderer::frustumCullNode(const World& world, const NodeVisit& visit, const Camera::Frustum& frustum) {
+    const OctreeNode& node = world.getNode(visit.nodeIndex);
 
     // Calculate node bounds
-    glm::vec3 center = glm::vec3(node->position) + glm::vec3(node->size / 2.0f);
-    float radius = node->size * 0.5f * settings.cullingMargin;
+    glm::vec3 center = glm::vec3(visit.position) + glm::vec3(visit.size / 2.0f);
 
     // Calculate distance to camera
     glm::vec3 toCenter = center - cameraPosition;
     float distance = glm::length(toCenter);
 
     // Check if node is visible
-    bool visible = !settings.enableFrustumCulling || isNodeVisible(node, frustum);
-
-    if (visible) {
-        // Calculate appropriate LOD level
-        uint32_t lodLevel = settings.enableLOD ? 
-            calculateLODLevel(node, distance) : node->level;
-
-        // Add to visible nodes
-        visibleNodes.push_back({
-            node,
-            distance,
-            lodLevel,
-            true
-        });
-
-        // Recursively check children if this isn't a leaf and we need more detail
-        if (!node->isLeaf && lodLevel > node->level) {
-            for (uint8_t i = 0; i < 8; ++i) {
-                if (node->childMask & (1 << i)) {
-                    frustumCullNode(node->nodeData.internal.children[i].get(), frustum);
-                }
-            }
-        }
+    bool visible = !settings.enableFrustumCulling || isNodeVisible(visit.position, visit.size, frustum);
+    if (!visible) {
+        return false;
     }
+
+    // Calculate appropriate LOD level
+    uint32_t lodLevel = settings.enableLOD ? 
+        calculateLODLevel(visit.size, distance) : node.level;
+
+    // Add to visible nodes
+    visibleNodes.push_back({
+        visit.nodeIndex,
+        visit.position,
+        visit.size,
+        node.level,
+        distance,
+        lodLevel,
+        true
+    });
+
+    // Descend only if we need more detail
+    return lodLevel > node.level;
 }
 
-bool WorldRenderer::isNodeVisible(const OctreeNode* node, const Camera::Frustum& frustum) const {
+bool WorldRenderer::isNodeVisible(const glm::ivec3& position, uint32_t size, const Camera::Frustum& frustum) const {
     // Calculate node bounds
-    glm::vec3 center = glm::vec3(node->position) + glm::vec3(node->size / 2.0f);
-    float radius = node->size * 0.5f * settings.cullingMargin;
+    glm::vec3 center = glm::vec3(position) + glm::vec3(size / 2.0f);
+    float radius = size * 0.5f * settings.cullingMargin;
 
     // Check against each frustum plane
     for (int i = 0; i < 6; ++i) {
@@ -378,22 +502,22 @@ bool WorldRenderer::isNodeVisible(const OctreeNode* node, const Camera::Frustum&
     return true;
 }
 
-uint32_t WorldRenderer::calculateLODLevel(const OctreeNode* node, float distance) const {
+uint32_t WorldRenderer::calculateLODLevel(uint32_t size, float distance) const {
     // Base LOD on distance and node size
-    float factor = distance / (node->size * settings.lodDistanceFactor);
+    float factor = distance / (size * settings.lodDistanceFactor);
     uint32_t level = static_cast<uint32_t>(glm::log2(factor));
     return glm::clamp(level, 0u, 8u); // Using 8 as MAX_LEVEL
 }
 
 float WorldRenderer::calculateNodePriority(const RenderNode& node) const {
     // Priority based on distance and size
-    float sizeFactor = node.node->size / static_cast<float>(1 << 8); // Using 8 as MAX_LEVEL
+    float sizeFactor = node.size / static_cast<float>(1 << 8); // Using 8 as MAX_LEVEL
     return sizeFactor / (node.distance + 1.0f);
 }
 
 void WorldRenderer::recordNodeCommands(VkCommandBuffer commandBuffer, const RenderNode& node) {
     // Skip if node has no mesh data
-    if (!node.node || !node.isVisible) {
+    if (!currentWorld || !node.isVisible) {
         std::cout << "WorldRenderer: Skipping invisible or null node" << std::endl;
         return;
     }
@@ -405,18 +529,23 @@ void WorldRenderer::recordNodeCommands(VkCommandBuffer commandBuffer, const Rend
     }
 
     // Try to find mesh data
-    const auto& meshes = node.node->getMeshes();
-    if (meshes.empty()) {
+    const MeshData* meshData = currentWorld->getMesh(node.nodeIndex);
+    if (!meshData) {
         std::cout << "WorldRenderer: Node has no meshes" << std::endl;
         return;
     }
 
-    if (!meshes[0].vertexBuffer || !meshes[0].indexBuffer) {
+    if (meshData->quadCount != 0) {
+        recordFaceListCommands(commandBuffer, node, *meshData);
+        return;
+    }
+
+    if (!meshData->vertexBuffer || !meshData->indexBuffer) {
         std::cout << "WorldRenderer: Mesh buffers are null" << std::endl;
         return;
     }
 
-    const auto& mesh = meshes[0];
+    const auto& mesh = *meshData;
     if (mesh.vertexCount == 0 || mesh.indexCount == 0) {
         std::cout << "WorldRenderer: Mesh has no vertices or indices" << std::endl;
         return;
@@ -432,11 +561,11 @@ void WorldRenderer::recordNodeCommands(VkCommandBuffer commandBuffer, const Rend
     VkBuffer vertexBuffers[] = {mesh.vertexBuffer};
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, mesh.indexType);
 
-    // Calculate and push model matrix
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(node.node->position));
-    model = glm::scale(model, glm::vec3(node.node->size));
+    // Meshes are node-local and span BRICK_SIZE units whatever the node size
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(node.position));
+    model = glm::scale(model, glm::vec3(static_cast<float>(node.size) / BRICK_SIZE));
     
     // Push model matrix as push constant
     vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
@@ -448,6 +577,21 @@ void WorldRenderer::recordNodeCommands(VkCommandBuffer commandBuffer, const Rend
     std::cout << "WorldRenderer: Successfully recorded draw commands for node" << std::endl;
 }
 
+void WorldRenderer::recordFaceListCommands(VkCommandBuffer commandBuffer, const RenderNode& node, const MeshData& mesh) {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, faceListPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, faceListPipelineLayout,
+                            0, 1, &quadSet, 0, nullptr);
+
+    FaceListPushConstants pushConstants;
+    pushConstants.viewProjection = viewProjection;
+    pushConstants.node = glm::vec4(glm::vec3(node.position), static_cast<float>(node.size) / BRICK_SIZE);
+    vkCmdPushConstants(commandBuffer, faceListPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                       0, sizeof(FaceListPushConstants), &pushConstants);
+
+    // Six vertices per quad, the first vertex offset selects the mesh's quads
+    vkCmdDraw(commandBuffer, mesh.quadCount * 6, 1, mesh.firstQuad * 6, 0);
+}
+
 void WorldRenderer::recordDebugCommands(VkCommandBuffer commandBuffer) {
     if (!debugMesh.vertexBuffer || !debugMesh.indexBuffer) {
         return;
@@ -460,10 +604,10 @@ void WorldRenderer::recordDebugCommands(VkCommandBuffer commandBuffer) {
 
     // Draw debug visualization for each visible node
     for (const auto& node : visibleNodes) {
-        if (node.isVisible && node.node) {
+        if (node.isVisible) {
             // Update push constants with node transform
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(node.node->position));
-            model = glm::scale(model, glm::vec3(node.node->size));
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(node.position));
+            model = glm::scale(model, glm::vec3(node.size));
             vkCmdPushConstants(commandBuffer, pipelineLayout, 
                 VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
 
@@ -474,42 +618,23 @@ void WorldRenderer::recordDebugCommands(VkCommandBuffer commandBuffer) {
 }
 
 bool WorldRenderer::createDebugResources() {
-    // Create cube mesh for debug visualization
-    std::vector<float> vertices = {
-        // Front face
-        -0.5f, -0.5f,  0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-        // Back face
-        -0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-        -0.5f,  0.5f, -0.5f,
-    };
-
-    std::vector<uint32_t> indices = {
-        // Front face
-        0, 1, 2, 2, 3, 0,
-        // Back face
-        4, 5, 6, 6, 7, 4,
-        // Left face
-        4, 0, 3, 3, 7, 4,
-        // Right face
-        1, 5, 6, 6, 2, 1,
-        // Top face
-        3, 2, 6, 6, 7, 3,
-        // Bottom face
-        4, 5, 1, 1, 0, 4
-    };
+    // Unit cube for debug visualization, in the packed mesh format the
+    // pipeline reads, scaled to each node's size when drawn
+    std::vector<MeshQuad> quads;
+    appendBoxQuads(1, 0, quads);
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    for (const MeshQuad& quad : quads) {
+        appendQuadVertices(quad, vertices, indices);
+    }
 
-    debugMesh.vertexCount = static_cast<uint32_t>(vertices.size()) / 3;
+    debugMesh.vertexCount = static_cast<uint32_t>(vertices.size());
     debugMesh.indexCount = static_cast<uint32_t>(indices.size());
 
     // Create vertex buffer
     VkBufferCreateInfo vertexBufferInfo{};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    vertexBufferInfo.size = vertices.size() * sizeof(float);
+    vertexBufferInfo.size = vertices.size() * sizeof(MeshVertex);
     vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
     vertexBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
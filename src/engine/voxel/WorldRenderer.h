@@ -9,7 +9,8 @@
 namespace voxceleron {
 
 class World;
-class OctreeNode;
+struct NodeVisit;
+struct MeshData;
 
 class WorldRenderer {
 public:
@@ -51,13 +52,29 @@ private:
     VkPhysicalDevice physicalDevice;
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;  // Graphics pipeline for mesh rendering
+
+    // Face-list meshes, pulled from the world's quad buffer by face.vert
+    struct FaceListPushConstants {
+        glm::mat4 viewProjection;
+        glm::vec4 node;             // Origin, and node size / BRICK_SIZE in w
+    };
+    VkPipelineLayout faceListPipelineLayout;
+    VkPipeline faceListPipeline;
+    VkDescriptorSetLayout quadSetLayout;
+    VkDescriptorPool quadDescriptorPool;
+    VkDescriptorSet quadSet;
+    VkBuffer boundQuadBuffer;     // Buffer quadSet points at
     Settings settings;
     bool debugVisualization;
     const Camera* currentCamera;  // Current camera being used for rendering
+    const World* currentWorld;    // World whose nodes are referenced by visibleNodes
 
     // Rendering data
     struct RenderNode {
-        const OctreeNode* node;
+        uint32_t nodeIndex;   // Index into the world's node pool
+        glm::ivec3 position;  // Node origin in world space
+        uint32_t size;        // Node extent in voxels
+        uint32_t level;       // Octree level of the node
         float distance;    // Distance to camera
         uint32_t lodLevel; // Actual LOD level to use
         bool isVisible;    // Whether node is visible
@@ -70,13 +87,14 @@ private:
 
     // Culling and LOD
     void updateVisibleNodes(const Camera& camera, World& world);
-    void frustumCullNode(const OctreeNode* node, const Camera::Frustum& frustum);
-    bool isNodeVisible(const OctreeNode* node, const Camera::Frustum& frustum) const;
-    uint32_t calculateLODLevel(const OctreeNode* node, float distance) const;
+    bool frustumCullNode(const World& world, const NodeVisit& visit, const Camera::Frustum& frustum);
+    bool isNodeVisible(const glm::ivec3& position, uint32_t size, const Camera::Frustum& frustum) const;
+    uint32_t calculateLODLevel(uint32_t size, float distance) const;
     float calculateNodePriority(const RenderNode& node) const;
 
     // Command recording
     void recordNodeCommands(VkCommandBuffer commandBuffer, const RenderNode& node);
+    void recordFaceListCommands(VkCommandBuffer commandBuffer, const RenderNode& node, const MeshData& mesh);
     void recordDebugCommands(VkCommandBuffer commandBuffer);
 
     // Vulkan resources
@@ -91,6 +109,10 @@ private:
     } debugMesh;
 
     // Vulkan helpers
+    bool createMeshPipeline(const std::string& vertexShader, const VkPipelineVertexInputStateCreateInfo& vertexInput,
+                            VkPipelineLayout layout, VkPipeline& pipeline);
+    bool createFaceListPipeline();
+    void updateQuadSet(VkBuffer quadBuffer);
     bool createDebugResources();
     void cleanupDebugResources();
     VkShaderModule createShaderModule(const std::string& filename);
@@ -0,0 +1,20 @@
+#include "WorldSnapshot.h"
+
+namespace voxceleron {
+
+Voxel WorldSnapshot::getVoxel(const glm::ivec3& pos) const {
+    uint32_t nodeIndex = findLeaf(*nodes, regions.find(World::regionCoord(pos)), REGION_SIZE, pos);
+    if (nodeIndex == INVALID_INDEX) {
+        return Voxel{MATERIAL_AIR};
+    }
+
+    const OctreeNode& node = (*nodes)[nodeIndex];
+    if (node.isUniform()) {
+        return unpackVoxel(node.payload);
+    }
+
+    glm::ivec3 localPos = pos & glm::ivec3(BRICK_SIZE - 1);
+    return unpackVoxel((*payloads)[node.payload].get(VoxelBrick::index(localPos)));
+}
+
+} // namespace voxceleron
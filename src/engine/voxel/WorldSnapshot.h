@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include "World.h"
+
+namespace voxceleron {
+
+// Immutable view of the world as it was when World::createSnapshot() ran.
+//
+// The snapshot owns a copy of each region root and shares everything below
+// with the live world. Edits made afterwards copy the path they touch before
+// writing, so nodes and bricks reachable from here never change. Any thread
+// may read a snapshot without locking while the world keeps being edited.
+class WorldSnapshot {
+public:
+    Voxel getVoxel(const glm::ivec3& pos) const;
+
+    uint32_t getRegionRoot(const glm::ivec3& regionCoord) const { return regions.find(regionCoord); }
+    size_t getRegionCount() const { return regions.size(); }
+    const OctreeNode& getNode(uint32_t index) const { return (*nodes)[index]; }
+    const PaletteBrick& getBrick(uint32_t payloadIndex) const { return (*payloads)[payloadIndex]; }
+
+    // Regions that were compressed when the snapshot was taken. They are not
+    // part of getVoxel or traverse; readers that need them can decode the
+    // stream with lz::decompress.
+    template<typename Visit>
+    void forEachCompressedRegion(Visit&& visit) const {
+        for (const auto& [coord, region] : compressedRegions) {
+            visit(coord, *region);
+        }
+    }
+
+    // Same contract as World::traverse
+    template<typename Pre, typename Post = NoPostVisit>
+    void traverse(Pre&& pre, Post&& post = Post(), uint32_t childOrder = 0) const {
+        regions.forEach([&](const glm::ivec3& coord, uint32_t rootIndex) {
+            traverseOctree<MAX_LEVEL + 1>(*nodes, NodeVisit{rootIndex, World::regionOrigin(coord), REGION_SIZE},
+                                          pre, post, childOrder);
+        });
+    }
+
+private:
+    friend class World;
+    friend class SnapshotAccessor;
+    WorldSnapshot(const NodePool& nodes, const LeafPayloadPool& payloads)
+        : nodes(&nodes), payloads(&payloads) {}
+
+    const NodePool* nodes;
+    const LeafPayloadPool* payloads;
+    RegionMap regions;      // Region coordinate to the snapshot's own root copy
+    std::vector<std::pair<glm::ivec3, std::shared_ptr<const CompressedRegion>>> compressedRegions;
+};
+
+} // namespace voxceleron
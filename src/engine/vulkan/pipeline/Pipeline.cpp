@@ -2,6 +2,7 @@
 #include "../core/VulkanContext.h"
 #include "../core/SwapChain.h"
 #include "../../core/Window.h"
+#include "../../voxel/MeshTypes.h"
 #include <iostream>
 #include <array>
 #include <chrono>
@@ -513,30 +514,15 @@ bool Pipeline::createGraphicsPipeline() {
     // Vertex input state
     VkVertexInputBindingDescription bindingDescription{};
     bindingDescription.binding = 0;
-    bindingDescription.stride = 9 * sizeof(float);  // pos(3) + normal(3) + uv(2) + lodBlend(1)
+    bindingDescription.stride = sizeof(MeshVertex);  // Packed, decoded in basic.vert
     bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-    std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+    std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions{};
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;  // position
+    attributeDescriptions[0].format = VK_FORMAT_R32G32_UINT;      // position and face, material and uv
     attributeDescriptions[0].offset = 0;
 
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;  // normal
-    attributeDescriptions[1].offset = 3 * sizeof(float);
-
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;    // uv
-    attributeDescriptions[2].offset = 6 * sizeof(float);
-
-    attributeDescriptions[3].binding = 0;
-    attributeDescriptions[3].location = 3;
-    attributeDescriptions[3].format = VK_FORMAT_R32_SFLOAT;      // lodBlend
-    attributeDescriptions[3].offset = 8 * sizeof(float);
-
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertexInputInfo.vertexBindingDescriptionCount = 1;